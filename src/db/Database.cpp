@@ -5,20 +5,17 @@
 #include "Database.h"
 
 #include <cstdlib>
-#include <deque>
 #include <fstream>
 #include <iomanip>
-#include <iostream>
-#include <memory>
+#include <ostream>
 #include <mutex>
-#include <sstream>
 #include <string>
 #include <utility>
-#include <vector>
 
-#include "../utils/formatter.h"
 #include "../utils/uexception.h"
+#include "DumpWriter.h"
 #include "Table.h"
+#include "TableSnapshot.h"
 
 void Database::testDuplicate(const std::string &tableName) {
   const std::lock_guard<std::recursive_mutex> lock(databaseMutex);
@@ -61,6 +58,12 @@ auto Database::operator[](const std::string &tableName) const -> const Table & {
   return *(iter->second);
 }
 
+auto Database::find(const std::string &tableName) const -> const Table * {
+  const std::lock_guard<std::recursive_mutex> lock(databaseMutex);
+  auto iter = this->tables.find(tableName);
+  return iter == this->tables.end() ? nullptr : iter->second.get();
+}
+
 void Database::dropTable(const std::string &tableName) {
   const std::lock_guard<std::recursive_mutex> lock(databaseMutex);
   auto iter = this->tables.find(tableName);
@@ -71,21 +74,21 @@ void Database::dropTable(const std::string &tableName) {
   this->tables.erase(iter);
 }
 
-void Database::printAllTable() {
+void Database::printAllTable(std::ostream &out) {
   const std::lock_guard<std::recursive_mutex> lock(databaseMutex);
   const int width = 15;
-  std::cout << "Database overview:" << '\n';
-  std::cout << "=========================" << '\n';
-  std::cout << std::setw(width) << "Table name";
-  std::cout << std::setw(width) << "# of fields";
-  std::cout << std::setw(width) << "# of entries" << '\n';
+  out << "Database overview:" << '\n';
+  out << "=========================" << '\n';
+  out << std::setw(width) << "Table name";
+  out << std::setw(width) << "# of fields";
+  out << std::setw(width) << "# of entries" << '\n';
   for (const auto &table : this->tables) {
-    std::cout << std::setw(width) << table.first;
-    std::cout << std::setw(width) << (*table.second).field().size() + 1;
-    std::cout << std::setw(width) << (*table.second).size() << '\n';
+    out << std::setw(width) << table.first;
+    out << std::setw(width) << (*table.second).field().size() + 1;
+    out << std::setw(width) << (*table.second).size() << '\n';
   }
-  std::cout << "Total " << this->tables.size() << " tables." << '\n';
-  std::cout << "=========================" << '\n';
+  out << "Total " << this->tables.size() << " tables." << '\n';
+  out << "=========================" << '\n';
 }
 
 auto Database::getInstance() -> Database & {
@@ -103,12 +106,19 @@ auto Database::getFileTableName(const std::string &fileName) -> std::string {
   const std::lock_guard<std::recursive_mutex> lock(databaseMutex);
   auto iter = fileTableNameMap.find(fileName);
   if (iter == fileTableNameMap.end()) {
-    std::ifstream infile(fileName);
+    DumpWriter::getInstance().waitFor(fileName);
+    std::ifstream infile(fileName, std::ios::binary);
     if (!infile.is_open()) {
       return "";
     }
     std::string tableName;
-    infile >> tableName;
+    if (auto snapshotName = TableSnapshot::peekName(infile)) {
+      tableName = std::move(*snapshotName);
+    } else {
+      infile.clear();
+      infile.seekg(0);
+      infile >> tableName;
+    }
     infile.close();
     fileTableNameMap.emplace(fileName, tableName);
     return tableName;
@@ -116,84 +126,6 @@ auto Database::getFileTableName(const std::string &fileName) -> std::string {
   return iter->second;
 }
 
-auto Database::loadTableFromStream(std::istream &input_stream,
-                                   const std::string &source) -> Table & {
-  auto &database = Database::getInstance();
-  std::string const errString =
-      !source.empty() ? R"(Invalid table (from "?") format: )"_f % source
-                      : "Invalid table format: ";
-
-  std::string tableName;
-  Table::SizeType fieldCount = 0;
-  std::deque<Table::KeyType> fields;
-
-  std::string line;
-  std::stringstream sstream;
-  if (!std::getline(input_stream, line)) {
-    throw LoadFromStreamException(errString +
-                                  "Failed to read table metadata line.");
-  }
-
-  sstream.str(line);
-  sstream >> tableName >> fieldCount;
-  if (!sstream) {
-    throw LoadFromStreamException(errString +
-                                  "Failed to parse table metadata.");
-  }
-
-  // throw error if tableName duplicates
-  database.testDuplicate(tableName);
-
-  if (!(std::getline(input_stream, line))) {
-    throw LoadFromStreamException(errString + "Failed to load field names.");
-  }
-
-  sstream.clear();
-  sstream.str(line);
-  for (Table::SizeType i = 0; i < fieldCount; ++i) {
-    std::string field;
-    if (!(sstream >> field)) {
-      throw LoadFromStreamException(errString + "Failed to load field names.");
-    }
-    fields.emplace_back(std::move(field));
-  }
-
-  if (fields.front() != "KEY") {
-    throw LoadFromStreamException(errString + "Missing or invalid KEY field.");
-  }
-
-  fields.erase(fields.begin());  // Remove leading key
-  auto table = std::make_unique<Table>(tableName, fields);
-
-  Table::SizeType lineCount = 2;
-  while (std::getline(input_stream, line)) {
-    if (line.empty()) {
-      break;  // Read to an empty line
-    }
-    lineCount++;
-    sstream.clear();
-    sstream.str(line);
-    std::string key;
-    if (!(sstream >> key)) {
-      throw LoadFromStreamException(errString +
-                                    "Missing or invalid KEY field.");
-    }
-    std::vector<Table::ValueType> tuple;
-    tuple.reserve(fieldCount - 1);
-    for (Table::SizeType i = 1; i < fieldCount; ++i) {
-      Table::ValueType value = 0;
-      if (!(sstream >> value)) {
-        throw LoadFromStreamException(errString + "Invalid row on LINE " +
-                                      std::to_string(lineCount));
-      }
-      tuple.emplace_back(value);
-    }
-    table->insertByIndex(key, std::move(tuple));
-  }
-
-  return database.registerTable(std::move(table));
-}
-
 void Database::exit() {
   // Throw exception to allow proper cleanup of resources
   // This allows RAII destructors to run properly
@@ -5,8 +5,11 @@
 #ifndef SRC_DB_DATABASE_H_
 #define SRC_DB_DATABASE_H_
 
+#include <istream>
+#include <ostream>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include "Table.h"
@@ -44,12 +47,19 @@ public:
 
   void dropTable(const std::string &tableName);
 
-  void printAllTable();
+  void printAllTable(std::ostream &out);
 
   auto operator[](const std::string &tableName) -> Table &;
 
   auto operator[](const std::string &tableName) const -> const Table &;
 
+  /**
+   * Look up a table without throwing
+   * @param tableName
+   * @return nullptr if there is no such table
+   */
+  auto find(const std::string &tableName) const -> const Table *;
+
   auto operator=(const Database &) -> Database & = delete;
 
   auto operator=(Database &&) -> Database & = delete;
@@ -76,6 +86,17 @@ public:
   static auto loadTableFromStream(std::istream &input_stream,
                                   const std::string &source = "") -> Table &;
 
+  /**
+   * Load a table from a buffer holding the text table format (i.e., a mapped
+   * file). Rows are parsed in parallel on line-aligned chunks. Buffers in
+   * the binary snapshot format are decoded by TableSnapshot.
+   * @param buffer
+   * @param source
+   * @return reference of loaded table
+   */
+  static auto loadTableFromBuffer(std::string_view buffer,
+                                  const std::string &source = "") -> Table &;
+
   static void exit();
 };
 
@@ -0,0 +1,279 @@
+//
+// Database table loading implementation
+// The text table format is parsed straight from a contiguous buffer: the two
+// metadata lines are read first, then the rows are split into line-aligned
+// chunks which are parsed in parallel with std::from_chars. Binary snapshots
+// are recognised by their magic and decoded by TableSnapshot instead.
+//
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "../utils/formatter.h"
+#include "../utils/uexception.h"
+#include "Database.h"
+#include "Table.h"
+#include "TableSnapshot.h"
+
+namespace {
+constexpr std::size_t kMinChunkBytes = 1U << 20U;  // 1 MiB per parse thread
+
+constexpr auto isBlank(char chr) -> bool {
+  return chr == ' ' || chr == '\t' || chr == '\n' || chr == '\v' ||
+         chr == '\f' || chr == '\r';
+}
+
+// Cursor over one line, mimicking istream extraction rules
+class LineCursor {
+public:
+  explicit LineCursor(std::string_view line) : line_(line) {}
+
+  auto nextToken() -> std::optional<std::string_view> {
+    skipBlank();
+    const std::size_t start = pos_;
+    while (pos_ < line_.size() && !isBlank(line_[pos_])) {
+      ++pos_;
+    }
+    if (start == pos_) {
+      return std::nullopt;
+    }
+    return line_.substr(start, pos_ - start);
+  }
+
+  template <typename Number> auto nextNumber(Number &out) -> bool {
+    skipBlank();
+    if (pos_ < line_.size() && line_[pos_] == '+') {
+      ++pos_;
+      if (pos_ < line_.size() && line_[pos_] == '-') {
+        return false;
+      }
+    }
+    const std::string_view rest = line_.substr(pos_);
+    const char *first = rest.data();
+    const char *last =
+        std::next(first, static_cast<std::ptrdiff_t>(rest.size()));
+    auto res = std::from_chars(first, last, out);
+    if (res.ec != std::errc()) {
+      return false;
+    }
+    pos_ += static_cast<std::size_t>(res.ptr - first);
+    return true;
+  }
+
+private:
+  void skipBlank() {
+    while (pos_ < line_.size() && isBlank(line_[pos_])) {
+      ++pos_;
+    }
+  }
+
+  std::string_view line_;
+  std::size_t pos_{0};
+};
+
+// Split off the next line (without '\n'); returns false at end of buffer
+auto nextLine(std::string_view &rest, std::string_view &line) -> bool {
+  if (rest.empty()) {
+    return false;
+  }
+  const auto newline = rest.find('\n');
+  line = rest.substr(0, newline);
+  rest = newline == std::string_view::npos ? std::string_view()
+                                           : rest.substr(newline + 1);
+  return true;
+}
+
+enum class RowError : std::uint8_t { None, MissingKey, InvalidRow };
+
+struct ParsedChunk {
+  std::vector<std::string> keys;
+  std::vector<Table::ValueType> values;  // row-major, valueCount per row
+  std::size_t lines{0};                  // rows parsed before any error
+  RowError error{RowError::None};
+};
+
+auto parseChunk(std::string_view chunk, std::size_t valueCount)
+    -> ParsedChunk {
+  ParsedChunk parsed;
+  std::string_view line;
+  while (nextLine(chunk, line)) {
+    LineCursor cursor(line);
+    auto key = cursor.nextToken();
+    if (!key) {
+      parsed.error = RowError::MissingKey;
+      return parsed;
+    }
+    for (std::size_t i = 0; i < valueCount; ++i) {
+      Table::ValueType value = 0;
+      if (!cursor.nextNumber(value)) {
+        parsed.values.resize(parsed.keys.size() * valueCount);
+        parsed.error = RowError::InvalidRow;
+        return parsed;
+      }
+      parsed.values.push_back(value);
+    }
+    parsed.keys.emplace_back(*key);
+    ++parsed.lines;
+  }
+  return parsed;
+}
+
+// Cut the row section into at most `parts` chunks ending on line boundaries
+auto splitRows(std::string_view rows,
+               std::size_t parts) -> std::vector<std::string_view> {
+  std::vector<std::string_view> chunks;
+  const std::size_t target = rows.size() / parts;
+  while (!rows.empty()) {
+    if (chunks.size() + 1 == parts || rows.size() <= target) {
+      chunks.push_back(rows);
+      break;
+    }
+    auto cut = rows.find('\n', target);
+    cut = cut == std::string_view::npos ? rows.size() : cut + 1;
+    chunks.push_back(rows.substr(0, cut));
+    rows.remove_prefix(cut);
+  }
+  return chunks;
+}
+
+auto parseRowsParallel(std::string_view rows,
+                       std::size_t valueCount) -> std::vector<ParsedChunk> {
+  std::size_t parts = std::max<std::size_t>(1, rows.size() / kMinChunkBytes);
+  parts = std::min<std::size_t>(
+      parts, std::max(1U, std::thread::hardware_concurrency()));
+  const auto chunks = splitRows(rows, parts);
+  std::vector<ParsedChunk> parsed(chunks.size());
+  if (chunks.size() <= 1) {
+    if (!chunks.empty()) {
+      parsed.front() = parseChunk(chunks.front(), valueCount);
+    }
+    return parsed;
+  }
+  std::vector<std::exception_ptr> errors(chunks.size());
+  std::vector<std::thread> workers;
+  workers.reserve(chunks.size());
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    workers.emplace_back([&, i]() {
+      try {
+        parsed[i] = parseChunk(chunks[i], valueCount);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  for (const auto &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  return parsed;
+}
+}  // namespace
+
+auto Database::loadTableFromStream(std::istream &input_stream,
+                                   const std::string &source) -> Table & {
+  const std::string buffer(std::istreambuf_iterator<char>(input_stream), {});
+  return loadTableFromBuffer(buffer, source);
+}
+
+auto Database::loadTableFromBuffer(std::string_view buffer,
+                                   const std::string &source) -> Table & {
+  auto &database = Database::getInstance();
+  if (TableSnapshot::isSnapshot(buffer)) {
+    auto table = TableSnapshot::read(buffer, source);
+    database.testDuplicate(table->name());
+    return database.registerTable(std::move(table));
+  }
+  std::string const errString =
+      !source.empty() ? R"(Invalid table (from "?") format: )"_f % source
+                      : "Invalid table format: ";
+
+  std::string_view rest = buffer;
+  std::string_view line;
+  if (!nextLine(rest, line)) {
+    throw LoadFromStreamException(errString +
+                                  "Failed to read table metadata line.");
+  }
+  LineCursor meta(line);
+  const auto tableName = meta.nextToken();
+  Table::SizeType fieldCount = 0;
+  if (!tableName || !meta.nextNumber(fieldCount)) {
+    throw LoadFromStreamException(errString +
+                                  "Failed to parse table metadata.");
+  }
+
+  // throw error if tableName duplicates
+  database.testDuplicate(std::string(*tableName));
+
+  if (!nextLine(rest, line)) {
+    throw LoadFromStreamException(errString + "Failed to load field names.");
+  }
+  std::vector<Table::KeyType> fields;
+  LineCursor fieldCursor(line);
+  for (Table::SizeType i = 0; i < fieldCount; ++i) {
+    auto field = fieldCursor.nextToken();
+    if (!field) {
+      throw LoadFromStreamException(errString + "Failed to load field names.");
+    }
+    fields.emplace_back(*field);
+  }
+  if (fields.empty() || fields.front() != "KEY") {
+    throw LoadFromStreamException(errString + "Missing or invalid KEY field.");
+  }
+  fields.erase(fields.begin());  // Remove leading key
+  auto table = std::make_unique<Table>(std::string(*tableName), fields);
+
+  // Rows end at the first empty line
+  if (!rest.empty() && rest.front() == '\n') {
+    rest = {};
+  } else if (auto blank = rest.find("\n\n"); blank != std::string_view::npos) {
+    rest = rest.substr(0, blank + 1);
+  }
+
+  auto chunks = parseRowsParallel(rest, fields.size());
+  std::size_t totalRows = 0;
+  for (const auto &chunk : chunks) {
+    totalRows += chunk.keys.size();
+  }
+  table->reserve(totalRows);
+
+  // Insert in file order so duplicate keys and bad rows fail as before
+  const auto valueCount = static_cast<std::ptrdiff_t>(fields.size());
+  Table::SizeType lineCount = 2;
+  for (auto &chunk : chunks) {
+    const auto *value = chunk.values.data();
+    for (auto &key : chunk.keys) {
+      const auto *rowEnd = std::next(value, valueCount);
+      std::vector<Table::ValueType> tuple(value, rowEnd);
+      value = rowEnd;
+      table->insertByIndex(std::move(key), std::move(tuple));
+    }
+    lineCount += chunk.lines;
+    if (chunk.error == RowError::MissingKey) {
+      throw LoadFromStreamException(errString +
+                                    "Missing or invalid KEY field.");
+    }
+    if (chunk.error == RowError::InvalidRow) {
+      throw LoadFromStreamException(errString + "Invalid row on LINE " +
+                                    std::to_string(lineCount + 1));
+    }
+  }
+
+  return database.registerTable(std::move(table));
+}
@@ -0,0 +1,91 @@
+//
+// DumpWriter implementation
+//
+
+#include "DumpWriter.h"
+
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "Table.h"
+#include "TableSnapshot.h"
+
+auto DumpWriter::getInstance() -> DumpWriter & {
+  static DumpWriter instance;
+  return instance;
+}
+
+DumpWriter::~DumpWriter() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void DumpWriter::submit(const std::string &path, std::ofstream &&out,
+                        Table::Ptr snapshot, bool binary) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    // The writer thread is only started once a dump is actually queued
+    if (!thread_.joinable()) {
+      thread_ = std::thread([this]() { run(); });
+    }
+    jobs_.push_back(Job{path, std::move(out), std::move(snapshot), binary});
+    ++pending_[path];
+  }
+  wake_.notify_one();
+}
+
+void DumpWriter::waitFor(const std::string &path) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [&]() { return !pending_.contains(path); });
+}
+
+void DumpWriter::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [&]() { return stopping_ || !jobs_.empty(); });
+    if (jobs_.empty()) {
+      return;  // stopping with nothing left to write
+    }
+    Job job = std::move(jobs_.front());
+    jobs_.pop_front();
+    lock.unlock();
+
+    std::string error;
+    try {
+      if (job.binary) {
+        TableSnapshot::write(job.out, *job.snapshot);
+      } else {
+        job.out << *job.snapshot;
+      }
+      job.out.close();
+      if (job.out.fail()) {
+        error = "could not write the file";
+      }
+    } catch (const std::exception &e) {
+      error = e.what();
+    }
+    if (!error.empty()) {
+      std::cerr << "lemondb: error: DUMP to '" << job.path
+                << "' failed: " << error << '\n';
+    }
+    job.snapshot.reset();
+
+    lock.lock();
+    auto iter = pending_.find(job.path);
+    if (iter != pending_.end() && --iter->second == 0) {
+      pending_.erase(iter);
+    }
+    done_.notify_all();
+  }
+}
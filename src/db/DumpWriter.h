@@ -0,0 +1,80 @@
+//
+// DumpWriter - background writer for asynchronous DUMP
+// DUMP copies the table while it holds the table lock and hands the copy to
+// this writer, so serialization and disk I/O happen off the worker threads.
+// Readers of a dumped file call waitFor() to observe the finished file.
+// The DUMP has already reported success by then, so a failed write is only
+// reported on stderr.
+//
+
+#ifndef SRC_DB_DUMPWRITER_H_
+#define SRC_DB_DUMPWRITER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <unordered_map>
+
+#include "Table.h"
+
+class DumpWriter {
+public:
+  static auto getInstance() -> DumpWriter &;
+
+  DumpWriter(const DumpWriter &) = delete;
+  auto operator=(const DumpWriter &) -> DumpWriter & = delete;
+  DumpWriter(DumpWriter &&) = delete;
+  auto operator=(DumpWriter &&) -> DumpWriter & = delete;
+
+  // Pending dumps are finished before the process exits
+  ~DumpWriter();
+
+  void setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto enabled() const -> bool {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Queue a table snapshot to be written to an already opened file
+   * @param path file name, used by waitFor()
+   * @param out opened output file
+   * @param snapshot private copy of the dumped table
+   * @param binary write the binary snapshot format instead of text
+   */
+  void submit(const std::string &path, std::ofstream &&out,
+              Table::Ptr snapshot, bool binary);
+
+  // Block until every queued dump to `path` has been written
+  void waitFor(const std::string &path);
+
+private:
+  DumpWriter() = default;
+
+  struct Job {
+    std::string path;
+    std::ofstream out;
+    Table::Ptr snapshot;
+    bool binary{false};
+  };
+
+  void run();
+
+  std::atomic<bool> enabled_{false};
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::deque<Job> jobs_;
+  std::unordered_map<std::string, std::size_t> pending_;
+  std::thread thread_;
+  bool stopping_{false};
+};
+
+#endif  // SRC_DB_DUMPWRITER_H_
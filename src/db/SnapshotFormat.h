@@ -0,0 +1,43 @@
+//
+// SnapshotFormat - constants and checksum shared by the TableSnapshot
+// reader and writer; see TableSnapshot.h for the layout
+//
+
+#ifndef SRC_DB_SNAPSHOTFORMAT_H_
+#define SRC_DB_SNAPSHOTFORMAT_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+
+namespace snapshot_detail {
+inline constexpr std::array<char, 8> kMagic{'L', 'E', 'M', 'O',
+                                            'N', 'D', 'B', '\0'};
+inline constexpr std::uint32_t kVersion = 2;
+inline constexpr std::uint32_t kByteOrderTag = 0x01020304U;
+inline constexpr std::uint64_t kChecksumSeed = 14695981039346656037ULL;
+
+/**
+ * FNV-1a over native 64-bit words, rotated after every word so that high
+ * bits reach the low ones; the bytes after the last whole word are hashed
+ * one at a time. Hashing a buffer in parts gives the same result as long
+ * as every part but the last holds whole words.
+ */
+auto checksum(std::string_view bytes,
+              std::uint64_t hash = kChecksumSeed) -> std::uint64_t;
+
+template <typename T>
+auto element(std::string_view array, std::size_t index) -> T {
+  T value{};
+  std::memcpy(&value,
+              std::next(array.data(),
+                        static_cast<std::ptrdiff_t>(index * sizeof(T))),
+              sizeof(T));
+  return value;
+}
+}  // namespace snapshot_detail
+
+#endif  // SRC_DB_SNAPSHOTFORMAT_H_
@@ -4,14 +4,17 @@
 
 #include "Table.h"
 
-#include <iomanip>
-#include <iostream>
-#include <sstream>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
 #include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "../utils/TextWriter.h"
 #include "../utils/formatter.h"
 #include "../utils/uexception.h"
 
@@ -24,14 +27,28 @@ auto Table::getFieldIndex(const Table::FieldNameType &field) const
   }
 }
 
-void Table::insertByIndex(const KeyType &key, std::vector<ValueType> &&data) {
+auto Table::findFieldIndex(const Table::FieldNameType &field) const
+    -> std::optional<Table::FieldIndex> {
+  auto iter = this->fieldMap.find(field);
+  if (iter == this->fieldMap.end()) {
+    return std::nullopt;
+  }
+  return iter->second;
+}
+
+auto Table::nextSchemaId() -> std::uint64_t {
+  static std::atomic<std::uint64_t> counter{0};
+  return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+void Table::insertByIndex(KeyType key, std::vector<ValueType> &&data) {
   if (this->keyMap.contains(key)) {
     std::string const err = "In Table \"" + this->tableName + "\" : Key \"" +
                             key + "\" already exists!";
     throw ConflictingKey(err);
   }
   this->keyMap.emplace(key, this->data.size());
-  this->data.emplace_back(key, std::move(data));
+  this->data.emplace_back(std::move(key), std::move(data));
 }
 
 auto Table::deleteByIndex(const KeyType &key) -> bool {
@@ -96,21 +113,25 @@ auto Table::operator[](const Table::KeyType &key) const
 }
 
 auto operator<<(std::ostream &os, const Table &table) -> std::ostream & {
-  const int width = 10;
-  std::stringstream buffer;
-  buffer << table.tableName << "\t" << (table.fields.size() + 1) << "\n";
-  buffer << std::setw(width) << "KEY";
+  const std::size_t width = 10;
+  TextWriter writer(os);
+  writer.put(table.tableName);
+  writer.put('\t');
+  writer.putInt(table.fields.size() + 1);
+  writer.put('\n');
+  writer.putRight("KEY", width);
   for (const auto &field : table.fields) {
-    buffer << std::setw(width) << field;
+    writer.putRight(field, width);
   }
-  buffer << "\n";
+  writer.put('\n');
   auto numFields = table.fields.size();
   for (const auto &datum : table.data) {
-    buffer << std::setw(width) << datum.key;
+    writer.putRight(datum.key, width);
     for (decltype(numFields) i = 0; i < numFields; ++i) {
-      buffer << std::setw(width) << datum.datum[i];
+      writer.putRightInt(datum.datum[i], width);
     }
-    buffer << "\n";
+    writer.put('\n');
   }
-  return os << buffer.str();
+  writer.flush();
+  return os;
 }
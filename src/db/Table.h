@@ -1,9 +1,11 @@
 #ifndef SRC_DB_TABLE_H_
 #define SRC_DB_TABLE_H_
 
+#include <cstdint>
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -55,6 +57,7 @@ private:
 
   public:
     friend class Table;
+    friend class TableSnapshot;
     template <class Iterator, class VType> friend class ObjectImpl;
     friend auto operator<<(std::ostream &os,
                            const Table &table) -> std::ostream &;
@@ -79,6 +82,9 @@ private:
   std::vector<Datum> data;
   std::unordered_map<KeyType, SizeType> keyMap;
   std::string tableName;
+  std::uint64_t schema{nextSchemaId()};
+
+  static auto nextSchemaId() -> std::uint64_t;
 
 public:
   using Ptr = std::unique_ptr<Table>;
@@ -227,7 +233,16 @@ public:
   }
   [[nodiscard]] auto
   getFieldIndex(const FieldNameType &field) const -> FieldIndex;
-  void insertByIndex(const KeyType &key, std::vector<ValueType> &&data);
+  [[nodiscard]] auto findFieldIndex(const FieldNameType &field) const
+      -> std::optional<FieldIndex>;
+  // Identifies the field layout: every table created (LOAD, COPYTABLE, ...)
+  // gets a new id, so anything resolved against an id stays valid for it
+  [[nodiscard]] auto schemaId() const -> std::uint64_t { return schema; }
+  void insertByIndex(KeyType key, std::vector<ValueType> &&data);
+  void reserve(SizeType rows) {
+    data.reserve(rows);
+    keyMap.reserve(rows);
+  }
   auto deleteByIndex(const KeyType &key) -> bool;
   auto duplicateByKey(const KeyType &src, const KeyType &dst) -> bool;
   auto operator[](const KeyType &key) -> Object::Ptr;
@@ -259,6 +274,7 @@ public:
   }
   friend auto operator<<(std::ostream &os,
                          const Table &table) -> std::ostream &;
+  friend class TableSnapshot;
 };
 auto operator<<(std::ostream &os, const Table &table) -> std::ostream &;
 
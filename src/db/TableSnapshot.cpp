@@ -0,0 +1,73 @@
+//
+// TableSnapshot implementation: format selection and checksum
+// The writer and the reader are in TableSnapshotWriter.cpp and
+// TableSnapshotReader.cpp
+//
+
+#include "TableSnapshot.h"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "SnapshotFormat.h"
+
+namespace {
+constexpr std::uint64_t kFnvPrime = 1099511628211ULL;
+constexpr int kWordRotate = 31;
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+std::atomic<DumpFormat> dumpFormat{DumpFormat::Auto};
+}  // namespace
+
+auto snapshot_detail::checksum(std::string_view bytes,
+                               std::uint64_t hash) -> std::uint64_t {
+  const std::size_t words = bytes.size() / sizeof(std::uint64_t);
+  for (std::size_t word = 0; word < words; ++word) {
+    hash ^= element<std::uint64_t>(bytes, word);
+    hash = std::rotl(hash * kFnvPrime, kWordRotate);
+  }
+  for (const char chr : bytes.substr(words * sizeof(std::uint64_t))) {
+    hash ^= static_cast<unsigned char>(chr);
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+auto TableSnapshot::isSnapshot(std::string_view buffer) -> bool {
+  using snapshot_detail::kMagic;
+  return buffer.starts_with(std::string_view(kMagic.data(), kMagic.size()));
+}
+
+auto TableSnapshot::parseFormat(std::string_view value)
+    -> std::optional<DumpFormat> {
+  if (value == "auto") {
+    return DumpFormat::Auto;
+  }
+  if (value == "text") {
+    return DumpFormat::Text;
+  }
+  if (value == "binary") {
+    return DumpFormat::Binary;
+  }
+  return std::nullopt;
+}
+
+void TableSnapshot::setDumpFormat(DumpFormat format) {
+  dumpFormat.store(format, std::memory_order_relaxed);
+}
+
+auto TableSnapshot::dumpAsBinary(std::string_view path) -> bool {
+  switch (dumpFormat.load(std::memory_order_relaxed)) {
+  case DumpFormat::Text:
+    return false;
+  case DumpFormat::Binary:
+    return true;
+  case DumpFormat::Auto:
+    break;
+  }
+  return path.ends_with(extension);
+}
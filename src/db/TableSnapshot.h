@@ -0,0 +1,69 @@
+//
+// TableSnapshot - versioned binary columnar table format
+// Layout (native byte order, checked by a byte-order tag):
+//   magic "LEMONDB\0", u32 version, u32 byte-order tag, u32 field count,
+//   u64 row count, name and field names (u32 length + bytes),
+//   (rows + 1) u64 key offsets, key blob, one i32 array per field,
+//   u64 checksum of everything before it, FNV-1a over 64-bit words.
+//
+
+#ifndef SRC_DB_TABLESNAPSHOT_H_
+#define SRC_DB_TABLESNAPSHOT_H_
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "Table.h"
+
+enum class DumpFormat : std::uint8_t { Auto, Text, Binary };
+
+class TableSnapshot {
+public:
+  static constexpr std::string_view extension = ".ldb";
+
+  /**
+   * Whether the buffer starts with the binary snapshot magic
+   */
+  static auto isSnapshot(std::string_view buffer) -> bool;
+
+  /**
+   * Write the table in the binary format
+   * @param os stream opened in binary mode
+   * @param table
+   */
+  static void write(std::ostream &os, const Table &table);
+
+  /**
+   * Decode a binary snapshot, verifying the checksum first
+   * @param buffer whole file contents
+   * @param source file name used in error messages
+   * @return the decoded table, not yet registered
+   */
+  static auto read(std::string_view buffer,
+                   const std::string &source = "") -> Table::Ptr;
+
+  /**
+   * Read only the table name from a snapshot header
+   * @return std::nullopt if the stream does not hold a snapshot
+   */
+  static auto peekName(std::istream &is) -> std::optional<std::string>;
+
+  /**
+   * Parse a --dump-format value (text, binary or auto)
+   */
+  static auto parseFormat(std::string_view value) -> std::optional<DumpFormat>;
+
+  static void setDumpFormat(DumpFormat format);
+
+  /**
+   * Whether DUMP to the given path writes the binary format; in auto mode
+   * this is decided by the ".ldb" extension
+   */
+  static auto dumpAsBinary(std::string_view path) -> bool;
+};
+
+#endif  // SRC_DB_TABLESNAPSHOT_H_
@@ -0,0 +1,181 @@
+//
+// TableSnapshot reader
+//
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../utils/formatter.h"
+#include "../utils/uexception.h"
+#include "SnapshotFormat.h"
+#include "Table.h"
+#include "TableSnapshot.h"
+
+using snapshot_detail::element;
+using snapshot_detail::kMagic;
+
+namespace {
+// Longest table name peekName accepts; a longer one is a corrupt header
+constexpr std::uint32_t kMaxNameLength = 1U << 16U;
+
+// Bounds-checked cursor over a snapshot body
+class SnapshotReader {
+public:
+  SnapshotReader(std::string_view data, const std::string &errString)
+      : data_(data), errString_(errString) {}
+
+  template <typename T> auto get() -> T {
+    T value{};
+    std::memcpy(&value, bytes(sizeof(T)).data(), sizeof(T));
+    return value;
+  }
+
+  auto getString() -> std::string_view {
+    return bytes(get<std::uint32_t>());
+  }
+
+  // Take `count` elements of `width` bytes, rejecting sizes that overflow
+  auto array(std::uint64_t count, std::size_t width) -> std::string_view {
+    if (count > remaining() / width) {
+      truncated();
+    }
+    return bytes(static_cast<std::size_t>(count) * width);
+  }
+
+  auto bytes(std::size_t count) -> std::string_view {
+    if (count > remaining()) {
+      truncated();
+    }
+    auto result = data_.substr(pos_, count);
+    pos_ += count;
+    return result;
+  }
+
+  [[nodiscard]] auto remaining() const -> std::size_t {
+    return data_.size() - pos_;
+  }
+
+private:
+  [[noreturn]] void truncated() const {
+    throw LoadFromStreamException(errString_ + "Truncated binary table.");
+  }
+
+  std::string_view data_;
+  std::size_t pos_{0};
+  const std::string &errString_;
+};
+
+// Bytes left in the stream after its current position, -1 if unknown
+auto remainingBytes(std::istream &is) -> std::streamoff {
+  const auto pos = is.tellg();
+  if (pos == std::streampos(-1) || !is.seekg(0, std::ios::end)) {
+    return -1;
+  }
+  const auto end = is.tellg();
+  if (!is.seekg(pos)) {
+    return -1;
+  }
+  return end - pos;
+}
+}  // namespace
+
+auto TableSnapshot::read(std::string_view buffer,
+                         const std::string &source) -> Table::Ptr {
+  std::string const errString =
+      !source.empty() ? R"(Invalid table (from "?") format: )"_f % source
+                      : "Invalid table format: ";
+  if (!isSnapshot(buffer) ||
+      buffer.size() < kMagic.size() + sizeof(std::uint64_t)) {
+    throw LoadFromStreamException(errString + "Truncated binary table.");
+  }
+  const auto body = buffer.substr(0, buffer.size() - sizeof(std::uint64_t));
+  if (snapshot_detail::checksum(body) !=
+      element<std::uint64_t>(buffer.substr(body.size()), 0)) {
+    throw LoadFromStreamException(errString + "Checksum mismatch.");
+  }
+
+  SnapshotReader reader(body.substr(kMagic.size()), errString);
+  const auto version = reader.get<std::uint32_t>();
+  if (version != snapshot_detail::kVersion) {
+    throw LoadFromStreamException(
+        errString + "Unsupported binary table version ?."_f % version);
+  }
+  if (reader.get<std::uint32_t>() != snapshot_detail::kByteOrderTag) {
+    throw LoadFromStreamException(errString + "Byte order mismatch.");
+  }
+  const auto fieldCount = reader.get<std::uint32_t>();
+  const auto rowCount = reader.get<std::uint64_t>();
+  const std::string name(reader.getString());
+  std::vector<Table::FieldNameType> fields;
+  for (std::uint32_t i = 0; i < fieldCount; ++i) {
+    fields.emplace_back(reader.getString());
+  }
+  auto table = std::make_unique<Table>(name, fields);
+
+  if (rowCount >= reader.remaining()) {
+    throw LoadFromStreamException(errString + "Truncated binary table.");
+  }
+  const auto offsets = reader.array(rowCount + 1, sizeof(std::uint64_t));
+  const auto blobSize = element<std::uint64_t>(offsets, rowCount);
+  const auto blob = reader.array(blobSize, 1);
+  std::vector<std::string_view> columns;
+  columns.reserve(fieldCount);
+  for (std::uint32_t i = 0; i < fieldCount; ++i) {
+    columns.push_back(reader.array(rowCount, sizeof(std::int32_t)));
+  }
+  if (reader.remaining() != 0) {
+    throw LoadFromStreamException(errString + "Malformed binary table.");
+  }
+  const auto rows = static_cast<std::size_t>(rowCount);
+  table->reserve(rows);
+  for (std::size_t row = 0; row < rows; ++row) {
+    const auto begin = element<std::uint64_t>(offsets, row);
+    const auto end = element<std::uint64_t>(offsets, row + 1);
+    if (begin > end || end > blobSize) {
+      throw LoadFromStreamException(errString + "Malformed binary table.");
+    }
+    std::vector<Table::ValueType> tuple(fieldCount);
+    for (std::uint32_t i = 0; i < fieldCount; ++i) {
+      tuple[i] = element<std::int32_t>(columns[i], row);
+    }
+    table->insertByIndex(
+        std::string(blob.substr(static_cast<std::size_t>(begin),
+                                static_cast<std::size_t>(end - begin))),
+        std::move(tuple));
+  }
+  return table;
+}
+
+auto TableSnapshot::peekName(std::istream &is) -> std::optional<std::string> {
+  std::array<char, kMagic.size()> magic{};
+  if (!is.read(magic.data(), magic.size()) || magic != kMagic) {
+    return std::nullopt;
+  }
+  // version, byte-order tag, field count and row count precede the name
+  constexpr std::streamoff skip = 3 * sizeof(std::uint32_t) +
+                                  sizeof(std::uint64_t);
+  std::uint32_t length = 0;
+  std::array<char, sizeof(length)> bytes{};
+  if (!is.seekg(skip, std::ios::cur) || !is.read(bytes.data(), bytes.size())) {
+    return std::nullopt;
+  }
+  std::memcpy(&length, bytes.data(), sizeof(length));
+  // The length is read before the checksum is verified
+  if (length > kMaxNameLength || length > remainingBytes(is)) {
+    return std::nullopt;
+  }
+  std::string name(length, '\0');
+  if (!is.read(name.data(), static_cast<std::streamsize>(length))) {
+    return std::nullopt;
+  }
+  return name;
+}
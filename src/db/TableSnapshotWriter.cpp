@@ -0,0 +1,104 @@
+//
+// TableSnapshot writer
+//
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "SnapshotFormat.h"
+#include "Table.h"
+#include "TableSnapshot.h"
+
+using snapshot_detail::checksum;
+using snapshot_detail::kMagic;
+
+namespace {
+constexpr std::size_t kFlushBytes = 1U << 16U;
+
+static_assert(sizeof(Table::ValueType) == sizeof(std::int32_t),
+              "snapshot columns store 32-bit values");
+
+// Buffers output and hashes every byte written before the checksum
+class SnapshotWriter {
+public:
+  explicit SnapshotWriter(std::ostream &os) : os_(os) {
+    buffer_.reserve(kFlushBytes);
+  }
+
+  template <typename T> void put(T value) {
+    std::array<char, sizeof(T)> bytes{};
+    std::memcpy(bytes.data(), &value, sizeof(T));
+    append({bytes.data(), bytes.size()});
+  }
+
+  void putString(std::string_view str) {
+    put(static_cast<std::uint32_t>(str.size()));
+    append(str);
+  }
+
+  void append(std::string_view bytes) {
+    buffer_.append(bytes);
+    if (buffer_.size() >= kFlushBytes) {
+      flush(false);
+    }
+  }
+
+  void finish() {
+    flush(true);
+    std::array<char, sizeof(hash_)> bytes{};
+    std::memcpy(bytes.data(), &hash_, sizeof(hash_));
+    os_.write(bytes.data(), bytes.size());
+  }
+
+private:
+  // The checksum runs over whole words, so before the end only those are
+  // written and the bytes after them stay buffered
+  void flush(bool last) {
+    const std::size_t size =
+        last ? buffer_.size()
+             : buffer_.size() - buffer_.size() % sizeof(std::uint64_t);
+    hash_ = checksum({buffer_.data(), size}, hash_);
+    os_.write(buffer_.data(), static_cast<std::streamsize>(size));
+    buffer_.erase(0, size);
+  }
+
+  std::ostream &os_;
+  std::string buffer_;
+  std::uint64_t hash_{snapshot_detail::kChecksumSeed};
+};
+}  // namespace
+
+void TableSnapshot::write(std::ostream &os, const Table &table) {
+  SnapshotWriter writer(os);
+  writer.append({kMagic.data(), kMagic.size()});
+  writer.put(snapshot_detail::kVersion);
+  writer.put(snapshot_detail::kByteOrderTag);
+  writer.put(static_cast<std::uint32_t>(table.fields.size()));
+  writer.put(static_cast<std::uint64_t>(table.data.size()));
+  writer.putString(table.tableName);
+  for (const auto &field : table.fields) {
+    writer.putString(field);
+  }
+
+  std::uint64_t offset = 0;
+  writer.put(offset);
+  for (const auto &datum : table.data) {
+    offset += datum.key.size();
+    writer.put(offset);
+  }
+  for (const auto &datum : table.data) {
+    writer.append(datum.key);
+  }
+
+  for (std::size_t field = 0; field < table.fields.size(); ++field) {
+    for (const auto &datum : table.data) {
+      writer.put(static_cast<std::int32_t>(datum.datum[field]));
+    }
+  }
+  writer.finish();
+}
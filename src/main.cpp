@@ -5,16 +5,20 @@
 #include <cstddef>
 #include <cstdlib>
 #include <exception>
-#include <fstream>
 #include <iostream>
 #include <memory>
 #include <span>
 #include <thread>  // NOLINT(build/c++11)
 
+#include "db/DumpWriter.h"
+#include "db/TableSnapshot.h"
 #include "query/QueryBuilders.h"
 #include "query/QueryParser.h"
 #include "runtime/QueryExecutor.h"
+#include "scheduler/GlobalIndex.h"
 #include "utils/ArgParser.h"
+#include "utils/MappedFile.h"
+#include "utils/OutputWriter.h"
 #include "utils/uexception.h"
 
 namespace {
@@ -25,16 +29,14 @@ auto run(std::span<char *> argv, int argc) -> int {
   std::ios_base::sync_with_stdio(false);
   const ParsedArgs parsedArgs = parseArgs(argv, argc);
 
-  std::ifstream fin;
+  MappedFile input;
   if (!parsedArgs.listen.empty()) {
-    fin.open(parsedArgs.listen);
-    if (!fin.is_open()) {
+    if (!input.open(parsedArgs.listen)) {
       std::cerr << "lemondb: error: " << parsedArgs.listen
                 << ": no such file or directory" << '\n';
       exit(-1);
     }
   }
-  std::istream input_stream(fin.rdbuf());
 
   // In production mode, listen argument must be defined
   if (parsedArgs.listen.empty()) {
@@ -50,6 +52,38 @@ auto run(std::span<char *> argv, int argc) -> int {
     exit(-1);
   }
 
+  if (auto format = TableSnapshot::parseFormat(parsedArgs.dumpFormat)) {
+    TableSnapshot::setDumpFormat(*format);
+  } else {
+    std::cerr << "lemondb: error: invalid dump format " << parsedArgs.dumpFormat
+              << " (expected text, binary or auto)" << '\n';
+    exit(-1);
+  }
+
+  if (auto policy = OutputWriter::parsePolicy(parsedArgs.outputFlush)) {
+    OutputWriter::getInstance().setPolicy(*policy);
+  } else {
+    std::cerr << "lemondb: error: invalid output flush policy "
+              << parsedArgs.outputFlush
+              << " (expected auto, query, idle or full)" << '\n';
+    exit(-1);
+  }
+
+  const auto tableOrder = GlobalIndex::parseOrder(parsedArgs.tableOrder);
+  if (!tableOrder) {
+    std::cerr << "lemondb: error: invalid table order " << parsedArgs.tableOrder
+              << " (expected backlog or fair)" << '\n';
+    exit(-1);
+  }
+
+  if (parsedArgs.ioThreads < 0) {
+    std::cerr << "lemondb: error: I/O threads num can not be negative value "
+              << parsedArgs.ioThreads << '\n';
+    exit(-1);
+  }
+
+  DumpWriter::getInstance().setEnabled(parsedArgs.asyncDump);
+
   // Determine thread count (default to 1 for single-threaded mode)
   size_t numThreads = 0;
   if (parsedArgs.threads > 0) {
@@ -76,12 +110,16 @@ auto run(std::span<char *> argv, int argc) -> int {
     std::cerr << '\n';
   }
 
-  QueryParser parser;
-  parser.registerQueryBuilder(std::make_unique<QueryBuilder(Debug)>());
-  parser.registerQueryBuilder(std::make_unique<QueryBuilder(ManageTable)>());
-  parser.registerQueryBuilder(std::make_unique<QueryBuilder(Complex)>());
+  auto parser = makeQueryParser();
 
-  executeQueries(input_stream, fin, parser, numThreads);
+  RuntimeOptions options;
+  options.ioThreads = static_cast<size_t>(parsedArgs.ioThreads);
+  options.batchPlan = parsedArgs.batchPlan;
+  options.tableOrder = *tableOrder;
+  options.affinity = parsedArgs.affinity;
+  options.numa = parsedArgs.numa;
+  options.actors = parsedArgs.actors;
+  executeQueries(input.view(), *parser, numThreads, options);
 
   return 0;
 }
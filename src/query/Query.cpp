@@ -4,26 +4,46 @@
 
 #include "Query.h"
 
-#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
-#include <stdexcept>
+#include <span>
 #include <string>
-#include <unordered_map>
 #include <utility>
 
 #include "../db/Table.h"
 #include "../utils/formatter.h"
 #include "../utils/uexception.h"
+#include "QueryPlan.h"
+
+auto ComplexQuery::planFor(const Table &table) -> const QueryPlan & {
+  if (plan == nullptr || planSchema != table.schemaId()) {
+    const std::span<const std::string> fieldOperands(operands.data(),
+                                                     fieldOperandCount());
+    plan = PlanCache::getInstance().get(table, fieldOperands, condition);
+    planSchema = table.schemaId();
+  }
+  return *plan;
+}
+
+auto ComplexQuery::operandIndex(const Table &table, std::size_t pos)
+    -> Table::FieldIndex {
+  const QueryPlan &resolved = planFor(table);
+  if (pos < resolved.operandIds.size() &&
+      resolved.operandIds[pos] != QueryPlan::kUnresolved) {
+    return resolved.operandIds[pos];
+  }
+  return table.getFieldIndex(operands[pos]);
+}
 
 auto ComplexQuery::initCondition(const Table &table)
     -> std::pair<std::string, bool> {
   constexpr int base_ten = 10;
-  const std::unordered_map<std::string, int> opmap{
-      {">", '>'}, {"<", '<'}, {"=", '='}, {">=", 'g'}, {"<=", 'l'},
-  };
+  const QueryPlan &resolved = planFor(table);
   std::pair<std::string, bool> result = {"", true};
-  for (auto &cond : condition) {
+  for (std::size_t i = 0; i < condition.size(); ++i) {
+    auto &cond = condition[i];
     if (cond.field == "KEY") {
       if (cond.op != "=") {
         throw IllFormedQueryCondition("Can only compare equivalence on KEY");
@@ -35,35 +55,17 @@ auto ComplexQuery::initCondition(const Table &table)
         return result;
       }
     } else {
-      cond.fieldId = table.getFieldIndex(cond.field);
+      cond.fieldId = resolved.conditionIds[i];
+      if (cond.fieldId == QueryPlan::kUnresolved) {
+        cond.fieldId = table.getFieldIndex(cond.field);  // throws
+      }
       cond.valueParsed = static_cast<Table::ValueType>(
           std::strtol(cond.value.c_str(), nullptr, base_ten));
-      int oper = 0;
-      try {
-        oper = opmap.at(cond.op);
-      } catch (const std::out_of_range &) {
+      cond.comp = resolved.comparators[i];
+      if (cond.comp == nullptr) {
         throw IllFormedQueryCondition(
             R"("?" is not a valid condition operator.)"_f % cond.op);
       }
-      switch (oper) {
-      case '>':
-        cond.comp = std::greater<>();
-        break;
-      case '<':
-        cond.comp = std::less<>();
-        break;
-      case '=':
-        cond.comp = std::equal_to<>();
-        break;
-      case 'g':
-        cond.comp = std::greater_equal<>();
-        break;
-      case 'l':
-        cond.comp = std::less_equal<>();
-        break;
-      default:
-        assert(0);  // should never be here
-      }
     }
   }
   return result;
@@ -5,6 +5,8 @@
 #ifndef SRC_QUERY_QUERY_H_
 #define SRC_QUERY_QUERY_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -14,6 +16,8 @@
 #include "../db/Table.h"
 #include "QueryResult.h"
 
+struct QueryPlan;
+
 // Type of Queries
 enum class QueryType : std::uint8_t {
   Load,        // WRITE
@@ -41,10 +45,13 @@ enum class QueryType : std::uint8_t {
 };
 
 struct QueryCondition {
+  using Comparator = bool (*)(const Table::ValueType &,
+                              const Table::ValueType &);
+
   std::string field;
   size_t fieldId{};
   std::string op;
-  std::function<bool(const Table::ValueType &, const Table::ValueType &)> comp;
+  Comparator comp{nullptr};
   std::string value;
   Table::ValueType valueParsed{};
 };
@@ -126,6 +133,24 @@ protected:
   // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes,misc-non-private-member-variables-in-classes)
   std::vector<QueryCondition> condition;
 
+  // Number of leading operands naming fields, the rest are constants
+  [[nodiscard]] virtual auto fieldOperandCount() const -> std::size_t {
+    return operands.size();
+  }
+
+  /**
+   * Index of the field named by operands[pos], resolved through the cached
+   * plan of this query's shape
+   * @throw TableFieldNotFound if the operand is not a field of the table
+   */
+  auto operandIndex(const Table &table, std::size_t pos) -> Table::FieldIndex;
+
+private:
+  std::shared_ptr<const QueryPlan> plan;
+  std::uint64_t planSchema = 0;  // schema the plan was resolved against
+
+  auto planFor(const Table &table) -> const QueryPlan &;
+
 public:
   using Ptr = std::unique_ptr<ComplexQuery>;
 
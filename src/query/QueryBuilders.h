@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -26,6 +27,15 @@
     Query::Ptr tryExtractQuery(const TokenizedQueryString &query) override;    \
   }
 
+// Builder reached directly through the parser's keyword dispatch
+#define KeywordQueryBuilderClass(name)                                         \
+  class QueryBuilder(name) : public BasicQueryBuilder {                        \
+    Query::Ptr tryExtractQuery(const TokenizedQueryString &query) override;    \
+    bool handlesKeyword(QueryKeyword keyword) const override;                  \
+    Query::Ptr tryExtractKeyword(QueryKeyword keyword,                         \
+                                 const TokenizedQueryString &query) override;  \
+  }
+
 #define ComplexQueryBuilderClass(name)                                         \
   class QueryBuilder(name) : public ComplexQueryBuilder {                      \
     Query::Ptr tryExtractQuery(const TokenizedQueryString &query) override;    \
@@ -44,7 +54,7 @@ public:
 
   // NOLINTNEXTLINE(readability-identifier-length)
   Query::Ptr tryExtractQuery(const TokenizedQueryString &q) final {
-    throw QueryBuilderMatchFailed(q.rawQeuryString);
+    throw QueryBuilderMatchFailed(std::string(q.rawQeuryString));
   }
 
   // NOLINTNEXTLINE(cppcoreguidelines-rvalue-reference-param-not-moved,
@@ -93,19 +103,29 @@ protected:
   std::string targetTable;
   std::vector<std::string> operandToken;
   std::vector<QueryCondition> conditionToken;
+  bool reportErrors;  // print why a query did not match
 
   virtual void parseToken(const TokenizedQueryString &query);
 
+  // Query object for a parsed data query, nullptr if not a data keyword
+  Query::Ptr makeQuery(QueryKeyword keyword);
+
 private:
-  void parseOperands(std::vector<std::string>::const_iterator *iter,
-                     const std::vector<std::string>::const_iterator &end);
-  void
-  parseWhereConditions(std::vector<std::string>::const_iterator *iter,
-                       const std::vector<std::string>::const_iterator &end);
+  using TokenIter = std::vector<std::string_view>::const_iterator;
+
+  void parseOperands(TokenIter *iter, const TokenIter &end);
+  void parseWhereConditions(TokenIter *iter, const TokenIter &end);
 
 public:
+  explicit ComplexQueryBuilder(bool reportErrors = true)
+      : reportErrors(reportErrors) {}
+
   void clear() override;
 
+  bool handlesKeyword(QueryKeyword keyword) const override;
+  Query::Ptr tryExtractKeyword(QueryKeyword keyword,
+                               const TokenizedQueryString &query) override;
+
   // Used as a debugging function.
   // Prints the parsed information
   Query::Ptr tryExtractQuery(const TokenizedQueryString &query) override;
@@ -122,13 +142,18 @@ public:
 BasicQueryBuilderClass(Fake);
 
 // Debug commands / Utils
-BasicQueryBuilderClass(Debug);
+KeywordQueryBuilderClass(Debug);
 
 // Load, dump, truncate and delete table
-BasicQueryBuilderClass(ManageTable);
+KeywordQueryBuilderClass(ManageTable);
 // NOLINTNEXTLINE(readability/nolint)
 // NOLINTEND(modernize-use-trailing-return-type)
 
+// Parser with the builder chain used by lemondb. Parsers working on input
+// chunks in parallel pass reportErrors = false and leave failed queries to be
+// parsed again, in order, by the main parser.
+auto makeQueryParser(bool reportErrors = true) -> std::unique_ptr<QueryParser>;
+
 // ComplexQueryBuilderClass(UpdateTable);
 // ComplexQueryBuilderClass(Insert);
 // ComplexQueryBuilderClass(Delete);
@@ -0,0 +1,219 @@
+//
+// ComplexQueryBuilder implementation: data queries of the form
+// $OPER$ ( args ) FROM table WHERE ( cond ) ...
+//
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../utils/formatter.h"
+#include "../utils/uexception.h"
+#include "Query.h"
+#include "QueryBuilders.h"
+#include "QueryKeywords.h"
+#include "QueryParser.h"
+#include "data/AddQuery.h"
+#include "data/CountQuery.h"
+#include "data/DeleteQuery.h"
+#include "data/DuplicateQuery.h"
+#include "data/InsertQuery.h"
+#include "data/MaxQuery.h"
+#include "data/MinQuery.h"
+#include "data/SelectQuery.h"
+#include "data/SubQuery.h"
+#include "data/SumQuery.h"
+#include "data/SwapQuery.h"
+#include "data/UpdateQuery.h"
+
+void ComplexQueryBuilder::parseOperands(
+    std::vector<std::string_view>::const_iterator *iter,
+    const std::vector<std::string_view>::const_iterator &end) {
+  if (**iter != "(") {
+    throw IllFormedQuery("Ill-formed operand.");
+  }
+  ++(*iter);
+  while (**iter != ")") {
+    this->operandToken.emplace_back(**iter);
+    ++(*iter);
+    if (*iter == end) {
+      throw IllFormedQuery("Ill-formed operand");
+    }
+  }
+  ++(*iter);
+}
+
+void ComplexQueryBuilder::parseWhereConditions(
+    std::vector<std::string_view>::const_iterator *iter,
+    const std::vector<std::string_view>::const_iterator &end) {
+  while (*iter != end) {
+    if (**iter != "(") {
+      throw IllFormedQuery("Ill-formed query condition");
+    }
+    QueryCondition cond;
+    cond.fieldId = 0;
+    cond.valueParsed = 0;
+    // cppcheck-suppress knownConditionTrueFalse
+    if (++(*iter) == end) {
+      throw IllFormedQuery("Missing field in condition");
+    }
+    cond.field = **iter;
+    if (++(*iter) == end) {
+      throw IllFormedQuery("Missing operator in condition");
+    }
+    cond.op = **iter;
+    if (++(*iter) == end) {
+      throw IllFormedQuery("Missing  in condition");
+    }
+    cond.value = **iter;
+    if (++(*iter) == end || **iter != ")") {
+      throw IllFormedQuery("Ill-formed query condition");
+    }
+    this->conditionToken.push_back(cond);
+    ++(*iter);
+  }
+}
+
+void ComplexQueryBuilder::parseToken(const TokenizedQueryString &query) {
+  // Treats forms like:
+  //
+  // $OPER$ ( arg1 arg2 ... )
+  // FROM table
+  // WHERE ( KEY = $STR$ ) ( $field$ $OP$ $int$ ) ...
+  //
+  // The "WHERE" clause can be ommitted
+  // The args of OPER clause can be ommitted
+
+  auto iter = query.token.cbegin();
+  auto end = query.token.cend();
+  iter += 1;  // Take to args;
+  if (iter == query.token.end()) {
+    throw IllFormedQuery("Missing FROM clause");
+  }
+  if (*iter != "FROM") {
+    parseOperands(&iter, end);
+    if (iter == end || *iter != "FROM") {
+      throw IllFormedQuery("Missing FROM clause");
+    }
+  }
+  if (++iter == end) {
+    throw IllFormedQuery("Missing targed table");
+  }
+  this->targetTable = *iter;
+  if (++iter == end) {  // the "WHERE" clause is ommitted
+    return;
+  }
+  if (*iter != "WHERE") {
+    // Hmmm, C++11 style Raw-string literal
+    // Reference:
+    // http://en.cppreference.com/w/cpp/language/string_literal
+    throw IllFormedQuery(R"(Expecting "WHERE", found "?".)"_f %
+                         std::string(*iter));
+  }
+  ++iter;
+  parseWhereConditions(&iter, end);
+}
+
+auto ComplexQueryBuilder::makeQuery(QueryKeyword keyword) -> Query::Ptr {
+  switch (keyword) {
+  case QueryKeyword::Insert:
+    return std::make_unique<InsertQuery>(this->targetTable, this->operandToken,
+                                         this->conditionToken);
+  case QueryKeyword::Update:
+    return std::make_unique<UpdateQuery>(this->targetTable, this->operandToken,
+                                         this->conditionToken);
+  case QueryKeyword::Select:
+    return std::make_unique<SelectQuery>(this->targetTable, this->operandToken,
+                                         this->conditionToken);
+  case QueryKeyword::Delete:
+    return std::make_unique<DeleteQuery>(this->targetTable, this->operandToken,
+                                         this->conditionToken);
+  case QueryKeyword::Duplicate:
+    return std::make_unique<DuplicateQuery>(
+        this->targetTable, this->operandToken, this->conditionToken);
+  case QueryKeyword::Count:
+    return std::make_unique<CountQuery>(this->targetTable, this->operandToken,
+                                        this->conditionToken);
+  case QueryKeyword::Sum:
+    return std::make_unique<SumQuery>(this->targetTable, this->operandToken,
+                                      this->conditionToken);
+  case QueryKeyword::Min:
+    return std::make_unique<MinQuery>(this->targetTable, this->operandToken,
+                                      this->conditionToken);
+  case QueryKeyword::Max:
+    return std::make_unique<MaxQuery>(this->targetTable, this->operandToken,
+                                      this->conditionToken);
+  case QueryKeyword::Add:
+    return std::make_unique<AddQuery>(this->targetTable, this->operandToken,
+                                      this->conditionToken);
+  case QueryKeyword::Sub:
+    return std::make_unique<SubQuery>(this->targetTable, this->operandToken,
+                                      this->conditionToken);
+  case QueryKeyword::Swap:
+    return std::make_unique<SwapQuery>(this->targetTable, this->operandToken,
+                                       this->conditionToken);
+  default:
+    return nullptr;
+  }
+}
+
+auto ComplexQueryBuilder::handlesKeyword(QueryKeyword keyword) const -> bool {
+  return keyword >= QueryKeyword::Insert && keyword <= QueryKeyword::Swap;
+}
+
+auto ComplexQueryBuilder::tryExtractKeyword(QueryKeyword keyword,
+                                            const TokenizedQueryString &query)
+    -> Query::Ptr {
+  try {
+    this->parseToken(query);
+  } catch (const IllFormedQuery &) {
+    return nullptr;  // the chain reports it
+  }
+  return makeQuery(keyword);
+}
+
+auto ComplexQueryBuilder::tryExtractQuery(const TokenizedQueryString &query)
+    -> Query::Ptr {
+  try {
+    this->parseToken(query);
+  } catch (const IllFormedQuery &exception) {
+    if (reportErrors) {
+      std::cerr << exception.what() << '\n';
+    }
+    return this->nextBuilder->tryExtractQuery(query);
+  }
+  if (auto result = makeQuery(lookupKeyword(query.token.front()))) {
+    return result;
+  }
+  if (!reportErrors) {
+    return this->nextBuilder->tryExtractQuery(query);
+  }
+  std::cerr << "Complicated query found!" << '\n';
+  std::cerr << "Operation = " << query.token.front() << '\n';
+  std::cerr << "    Operands : ";
+  for (const auto &oprand : this->operandToken) {
+    std::cerr << oprand << " ";
+  }
+  std::cerr << '\n';
+  std::cerr << "Target Table = " << this->targetTable << '\n';
+  if (this->conditionToken.empty()) {
+    std::cerr << "No WHERE clause specified." << '\n';
+  } else {
+    std::cerr << "Conditions = ";
+  }
+  for (const auto &cond : this->conditionToken) {
+    std::cerr << cond.field << cond.op << cond.value << " ";
+  }
+  std::cerr << '\n';
+
+  return this->nextBuilder->tryExtractQuery(query);
+}
+
+void ComplexQueryBuilder::clear() {
+  this->conditionToken.clear();
+  this->targetTable = "";
+  this->operandToken.clear();
+  this->nextBuilder->clear();
+}
@@ -0,0 +1,75 @@
+//
+// QueryChunks implementation
+//
+
+#include "QueryChunks.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <string_view>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "QueryBuilders.h"
+#include "QueryParser.h"
+
+namespace {
+constexpr std::size_t kMinChunkBytes = 1U << 20U;  // 1 MiB per parse thread
+
+// Cut the input into at most `parts` chunks ending right after a ';'
+auto splitQueries(std::string_view input,
+                  std::size_t parts) -> std::vector<std::string_view> {
+  std::vector<std::string_view> chunks;
+  const std::size_t target = input.size() / parts;
+  while (!input.empty()) {
+    if (chunks.size() + 1 == parts || input.size() <= target) {
+      chunks.push_back(input);
+      break;
+    }
+    auto cut = input.find(';', target);
+    cut = cut == std::string_view::npos ? input.size() : cut + 1;
+    chunks.push_back(input.substr(0, cut));
+    input.remove_prefix(cut);
+  }
+  return chunks;
+}
+
+auto parseChunk(std::string_view chunk) -> ParsedChunk {
+  auto parser = makeQueryParser(false);
+  ParsedChunk parsed;
+  for (auto end = chunk.find(';'); end != std::string_view::npos;
+       end = chunk.find(';')) {
+    ChunkEntry entry;
+    entry.deferred = chunk.substr(0, end);
+    chunk.remove_prefix(end + 1);
+    if (!QueryParser::dependsOnParseOrder(entry.deferred)) {
+      try {
+        entry.query = parser->parseQuery(entry.deferred);
+      } catch (const std::exception &) {  // NOLINT(bugprone-empty-catch)
+        // Reported when the caller parses it again
+      }
+    }
+    parsed.push_back(std::move(entry));
+  }
+  // Trailing text without ';' is not a query, as in sequential parsing
+  return parsed;
+}
+}  // namespace
+
+auto parseChunksAsync(std::string_view input)
+    -> std::vector<std::future<ParsedChunk>> {
+  std::size_t parts = input.size() / kMinChunkBytes;
+  parts = std::min<std::size_t>(
+      parts, std::max(1U, std::thread::hardware_concurrency()));
+  std::vector<std::future<ParsedChunk>> futures;
+  if (parts <= 1) {
+    return futures;
+  }
+  for (const auto chunk : splitQueries(input, parts)) {
+    futures.push_back(std::async(std::launch::async, parseChunk, chunk));
+  }
+  return futures;
+}
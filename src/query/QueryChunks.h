@@ -0,0 +1,31 @@
+//
+// QueryChunks - parallel parsing of large query buffers
+// The buffer is cut into chunks at ';' boundaries and every chunk is parsed
+// by its own thread with its own QueryParser. Queries whose parsing depends
+// on earlier queries (LOAD/DUMP) and queries that fail to parse are left as
+// raw strings, to be parsed by the caller in input order.
+//
+
+#ifndef SRC_QUERY_QUERYCHUNKS_H_
+#define SRC_QUERY_QUERYCHUNKS_H_
+
+#include <future>
+#include <string_view>
+#include <vector>
+
+#include "Query.h"
+
+struct ChunkEntry {
+  Query::Ptr query;          // null if the query has to be parsed in order
+  std::string_view deferred;  // raw query string when query is null
+};
+
+using ParsedChunk = std::vector<ChunkEntry>;
+
+// Start parsing `input` in parallel. Returns one future per chunk in input
+// order, or nothing if the input is too small to be worth splitting. `input`
+// must stay alive until every future has been consumed.
+auto parseChunksAsync(std::string_view input)
+    -> std::vector<std::future<ParsedChunk>>;
+
+#endif  // SRC_QUERY_QUERYCHUNKS_H_
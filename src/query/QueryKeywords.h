@@ -0,0 +1,113 @@
+#ifndef SRC_QUERY_QUERYKEYWORDS_H_
+#define SRC_QUERY_QUERYKEYWORDS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Leading keyword of a query string
+enum class QueryKeyword : std::uint8_t {
+  Unknown,
+  // Debug
+  List,
+  Quit,
+  ShowTable,
+  Listen,
+  // Table management
+  Load,
+  Drop,
+  Truncate,
+  Dump,
+  CopyTable,
+  // Data queries
+  Insert,
+  Update,
+  Select,
+  Delete,
+  Duplicate,
+  Count,
+  Sum,
+  Min,
+  Max,
+  Add,
+  Sub,
+  Swap,
+  Count_  // number of keywords, keep last
+};
+
+namespace keyword_detail {
+struct Entry {
+  std::string_view name;
+  QueryKeyword keyword{QueryKeyword::Unknown};
+};
+
+inline constexpr std::array<Entry, 21> kKeywords{{
+    {"LIST", QueryKeyword::List},
+    {"QUIT", QueryKeyword::Quit},
+    {"SHOWTABLE", QueryKeyword::ShowTable},
+    {"LISTEN", QueryKeyword::Listen},
+    {"LOAD", QueryKeyword::Load},
+    {"DROP", QueryKeyword::Drop},
+    {"TRUNCATE", QueryKeyword::Truncate},
+    {"DUMP", QueryKeyword::Dump},
+    {"COPYTABLE", QueryKeyword::CopyTable},
+    {"INSERT", QueryKeyword::Insert},
+    {"UPDATE", QueryKeyword::Update},
+    {"SELECT", QueryKeyword::Select},
+    {"DELETE", QueryKeyword::Delete},
+    {"DUPLICATE", QueryKeyword::Duplicate},
+    {"COUNT", QueryKeyword::Count},
+    {"SUM", QueryKeyword::Sum},
+    {"MIN", QueryKeyword::Min},
+    {"MAX", QueryKeyword::Max},
+    {"ADD", QueryKeyword::Add},
+    {"SUB", QueryKeyword::Sub},
+    {"SWAP", QueryKeyword::Swap},
+}};
+
+// FNV-1a with a seed chosen so that every keyword gets its own slot
+inline constexpr std::uint32_t kSeed = 14;
+inline constexpr std::uint32_t kPrime = 16777619;
+inline constexpr std::size_t kSlots = 64;
+
+constexpr auto slotOf(std::string_view word) -> std::size_t {
+  std::uint32_t hash = kSeed;
+  for (const char chr : word) {
+    hash = (hash ^ static_cast<unsigned char>(chr)) * kPrime;
+  }
+  return hash % kSlots;
+}
+
+constexpr auto buildTable() -> std::array<Entry, kSlots> {
+  std::array<Entry, kSlots> table{};
+  for (const auto &entry : kKeywords) {
+    table[slotOf(entry.name)] = entry;  // NOLINT
+  }
+  return table;
+}
+
+inline constexpr std::array<Entry, kSlots> kTable = buildTable();
+
+constexpr auto isPerfect() -> bool {
+  for (const auto &entry : kKeywords) {
+    if (kTable[slotOf(entry.name)].keyword != entry.keyword) {  // NOLINT
+      return false;
+    }
+  }
+  return true;
+}
+static_assert(isPerfect(), "keyword hash has collisions, pick another seed");
+static_assert(kKeywords.size() + 1 ==
+                  static_cast<std::size_t>(QueryKeyword::Count_),
+              "every keyword needs a table entry");
+}  // namespace keyword_detail
+
+// Map the first token of a query to its keyword with one hash and one
+// string comparison
+constexpr auto lookupKeyword(std::string_view word) -> QueryKeyword {
+  const auto &entry = keyword_detail::kTable[keyword_detail::slotOf(word)];
+  return entry.name == word ? entry.keyword : QueryKeyword::Unknown;
+}
+
+#endif  // SRC_QUERY_QUERYKEYWORDS_H_
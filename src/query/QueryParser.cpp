@@ -1,28 +1,48 @@
 #include "QueryParser.h"
 
-#include <sstream>
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include "../utils/uexception.h"
 #include "Query.h"
 #include "QueryBuilders.h"
 
+namespace {
+// Same separators as istream extraction in the "C" locale
+constexpr std::string_view kBlanks = " \t\n\v\f\r";
+}  // namespace
+
 QueryParser::QueryParser() : first(nullptr) {}
 
-auto QueryParser::parseQuery(const std::string &queryString) -> Query::Ptr {
+auto QueryParser::parseQuery(std::string_view queryString) -> Query::Ptr {
   if (first == nullptr) {
-    throw QueryBuilderMatchFailed(queryString);
+    throw QueryBuilderMatchFailed(std::string(queryString));
   }
   auto tokenized = tokenizeQueryString(queryString);
   if (tokenized.token.empty()) {
     throw QueryBuilderMatchFailed("");
   }
+  const QueryKeyword keyword = lookupKeyword(tokenized.token.front());
+  QueryBuilder *builder = dispatch.at(static_cast<std::size_t>(keyword));
+  if (builder != nullptr) {
+    builder->clear();
+    if (auto query = builder->tryExtractKeyword(keyword, tokenized)) {
+      return query;
+    }
+  }
   first->clear();
   return first->tryExtractQuery(tokenized);
 }
 
 void QueryParser::registerQueryBuilder(QueryBuilder::Ptr &&qBuilder) {
+  for (std::size_t i = 0; i < dispatch.size(); ++i) {
+    if (dispatch.at(i) == nullptr &&
+        qBuilder->handlesKeyword(static_cast<QueryKeyword>(i))) {
+      dispatch.at(i) = qBuilder.get();
+    }
+  }
   if (first == nullptr) {
     first = std::move(qBuilder);
     last = first.get();
@@ -35,15 +55,25 @@ void QueryParser::registerQueryBuilder(QueryBuilder::Ptr &&qBuilder) {
   }
 }
 
-auto QueryParser::tokenizeQueryString(const std::string &queryString)
+auto QueryParser::tokenizeQueryString(std::string_view queryString)
     -> TokenizedQueryString {
   TokenizedQueryString tokenized;
   tokenized.rawQeuryString = queryString;
-  std::stringstream stream;
-  stream.str(queryString);
-  std::string tStr;
-  while (stream >> tStr) {
-    tokenized.token.push_back(tStr);
+  std::size_t pos = queryString.find_first_not_of(kBlanks);
+  while (pos != std::string_view::npos) {
+    const std::size_t end = queryString.find_first_of(kBlanks, pos);
+    tokenized.token.push_back(queryString.substr(pos, end - pos));
+    pos = queryString.find_first_not_of(kBlanks, end);
   }
   return tokenized;
 }
+
+auto QueryParser::dependsOnParseOrder(std::string_view queryString) -> bool {
+  const std::size_t start = queryString.find_first_not_of(kBlanks);
+  if (start == std::string_view::npos) {
+    return false;
+  }
+  const std::size_t end = queryString.find_first_of(kBlanks, start);
+  const std::string_view head = queryString.substr(start, end - start);
+  return head == "LOAD" || head == "DUMP";
+}
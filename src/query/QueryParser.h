@@ -1,15 +1,21 @@
 #ifndef SRC_QUERY_QUERYPARSER_H_
 #define SRC_QUERY_QUERYPARSER_H_
 
+#include <array>
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "Query.h"
+#include "QueryKeywords.h"
 
+// Tokens are views into the query text, which must outlive the builders'
+// tryExtractQuery call; builders copy out whatever they keep
 struct TokenizedQueryString {
-  std::vector<std::string> token;
-  std::string rawQeuryString;
+  std::vector<std::string_view> token;
+  std::string_view rawQeuryString;
 };
 
 // NOLINTBEGIN(cppcoreguidelines-special-member-functions,
@@ -24,6 +30,16 @@ public:
   virtual void setNext(Ptr &&builder) = 0;
   virtual void clear() = 0;
 
+  // Fast path for builders the parser dispatches to by leading keyword.
+  // Returns nullptr if the tokens do not form such a query; the parser then
+  // walks the whole chain, which also produces the diagnostics.
+  virtual bool handlesKeyword(QueryKeyword /*keyword*/) const { return false; }
+  virtual Query::Ptr
+  tryExtractKeyword(QueryKeyword /*keyword*/,
+                    const TokenizedQueryString & /*queryString*/) {
+    return nullptr;
+  }
+
   virtual ~QueryBuilder() = default;
 };
 // NOLINTEND(cppcoreguidelines-special-member-functions,
@@ -35,14 +51,22 @@ public:
 class QueryParser {
   QueryBuilder::Ptr first;      // An owning pointer
   QueryBuilder *last{nullptr};  // None owning reference
+  // First registered builder claiming each keyword, None owning references
+  std::array<QueryBuilder *, static_cast<std::size_t>(QueryKeyword::Count_)>
+      dispatch{};
 
   static TokenizedQueryString
-  tokenizeQueryString(const std::string &queryString);
+  tokenizeQueryString(std::string_view queryString);
 
 public:
-  Query::Ptr parseQuery(const std::string &queryString);
+  Query::Ptr parseQuery(std::string_view queryString);
   void registerQueryBuilder(QueryBuilder::Ptr &&qBuilder);
 
+  // Whether building this query reads or updates state shared between
+  // queries (the Database file-table map of LOAD/DUMP), so it has to be
+  // parsed in input order
+  static bool dependsOnParseOrder(std::string_view queryString);
+
   QueryParser();
   ~QueryParser() = default;
 };
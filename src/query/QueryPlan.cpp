@@ -0,0 +1,144 @@
+//
+// QueryPlan implementation
+//
+
+#include "QueryPlan.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../db/Table.h"
+#include "Query.h"
+
+namespace {
+template <typename Compare>
+auto compareWith(const Table::ValueType &lhs,
+                 const Table::ValueType &rhs) -> bool {
+  return Compare()(lhs, rhs);
+}
+
+// Mix one more hash into the hash of a shape
+auto combine(std::size_t seed, std::size_t value) -> std::size_t {
+  constexpr std::size_t golden = 0x9e3779b97f4a7c15ULL;
+  return seed ^ (value + golden + (seed << 6U) + (seed >> 2U));
+}
+
+auto resolve(const Table &table, std::span<const std::string> fieldOperands,
+             const std::vector<QueryCondition> &conditions) -> QueryPlan {
+  QueryPlan plan;
+  plan.operandIds.reserve(fieldOperands.size());
+  for (const auto &field : fieldOperands) {
+    plan.operandIds.push_back(
+        table.findFieldIndex(field).value_or(QueryPlan::kUnresolved));
+  }
+  plan.conditionIds.reserve(conditions.size());
+  plan.comparators.reserve(conditions.size());
+  for (const auto &cond : conditions) {
+    plan.conditionIds.push_back(
+        table.findFieldIndex(cond.field).value_or(QueryPlan::kUnresolved));
+    plan.comparators.push_back(parseComparator(cond.op));
+  }
+  return plan;
+}
+}  // namespace
+
+auto parseComparator(std::string_view oper) -> QueryCondition::Comparator {
+  if (oper == ">") {
+    return compareWith<std::greater<>>;
+  }
+  if (oper == "<") {
+    return compareWith<std::less<>>;
+  }
+  if (oper == "=") {
+    return compareWith<std::equal_to<>>;
+  }
+  if (oper == ">=") {
+    return compareWith<std::greater_equal<>>;
+  }
+  if (oper == "<=") {
+    return compareWith<std::less_equal<>>;
+  }
+  return nullptr;
+}
+
+auto PlanCache::getInstance() -> PlanCache & {
+  static PlanCache instance;
+  return instance;
+}
+
+auto PlanCache::ShapeEqual::operator()(const Shape &lhs,
+                                      const Shape &rhs) const -> bool {
+  return lhs.hash == rhs.hash && lhs.schemaId == rhs.schemaId &&
+         lhs.fields == rhs.fields && lhs.conditions == rhs.conditions;
+}
+
+auto PlanCache::ShapeEqual::operator()(const ShapeRef &lhs,
+                                      const Shape &rhs) const -> bool {
+  return lhs.hash == rhs.hash && lhs.schemaId == rhs.schemaId &&
+         std::ranges::equal(lhs.fields, rhs.fields) &&
+         std::ranges::equal(
+             *lhs.conditions, rhs.conditions,
+             [](const QueryCondition &cond,
+                const std::pair<std::string, std::string> &stored) {
+               return cond.field == stored.first && cond.op == stored.second;
+             });
+}
+
+auto PlanCache::get(const Table &table,
+                    std::span<const std::string> fieldOperands,
+                    const std::vector<QueryCondition> &conditions)
+    -> std::shared_ptr<const QueryPlan> {
+  // Fields and operators only; condition values are constants
+  ShapeRef key{0, table.schemaId(), fieldOperands, &conditions};
+  const std::hash<std::string_view> hashString;
+  key.hash = std::hash<std::uint64_t>()(key.schemaId);
+  for (const auto &field : fieldOperands) {
+    key.hash = combine(key.hash, hashString(field));
+  }
+  key.hash = combine(key.hash, fieldOperands.size());
+  for (const auto &cond : conditions) {
+    key.hash = combine(combine(key.hash, hashString(cond.field)),
+                       hashString(cond.op));
+  }
+
+  Stripe &stripe = stripes_[key.hash % kStripes];
+  {
+    const std::shared_lock lock(stripe.mutex);
+    auto planIt = stripe.plans.find(key);
+    if (planIt != stripe.plans.end()) {
+      return planIt->second;
+    }
+  }
+  // Resolve outside the lock; a racing thread resolves the same plan
+  auto plan = std::make_shared<const QueryPlan>(
+      resolve(table, fieldOperands, conditions));
+  Shape shape{key.hash, key.schemaId,
+              {fieldOperands.begin(), fieldOperands.end()}, {}};
+  shape.conditions.reserve(conditions.size());
+  for (const auto &cond : conditions) {
+    shape.conditions.emplace_back(cond.field, cond.op);
+  }
+  const std::unique_lock lock(stripe.mutex);
+  return stripe.plans.try_emplace(std::move(shape), std::move(plan))
+      .first->second;
+}
+
+void PlanCache::dropSchema(std::uint64_t schemaId) {
+  for (Stripe &stripe : stripes_) {
+    const std::unique_lock lock(stripe.mutex);
+    std::erase_if(stripe.plans, [schemaId](const auto &entry) {
+      return entry.first.schemaId == schemaId;
+    });
+  }
+}
@@ -0,0 +1,119 @@
+//
+// QueryPlan - field resolution cached per query shape
+// A shape is the list of field operands plus the (field, operator) pairs of
+// the WHERE clause; constants are not part of it. The plan of a shape holds
+// the field indices and comparators resolved against one table schema, so
+// repeated queries of the same shape skip the lookups. Plans are keyed by
+// Table::schemaId() and dropped together with their table. A lookup hashes
+// the query's own strings and copies them only when it resolves a new plan;
+// the cache is split into stripes so that workers rarely share a lock.
+//
+
+#ifndef SRC_QUERY_QUERYPLAN_H_
+#define SRC_QUERY_QUERYPLAN_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../db/Table.h"
+#include "Query.h"
+
+struct QueryPlan {
+  // Operand or condition that is not a field of the table (or is KEY);
+  // resolving it again through the Table reports the error
+  static constexpr Table::FieldIndex kUnresolved =
+      std::numeric_limits<Table::FieldIndex>::max();
+
+  std::vector<Table::FieldIndex> operandIds;
+  std::vector<Table::FieldIndex> conditionIds;
+  std::vector<QueryCondition::Comparator> comparators;  // null if invalid op
+};
+
+// Comparator of a condition operator, nullptr if the operator is invalid
+auto parseComparator(std::string_view oper) -> QueryCondition::Comparator;
+
+class PlanCache {
+public:
+  static auto getInstance() -> PlanCache &;
+
+  PlanCache(const PlanCache &) = delete;
+  auto operator=(const PlanCache &) -> PlanCache & = delete;
+  PlanCache(PlanCache &&) = delete;
+  auto operator=(PlanCache &&) -> PlanCache & = delete;
+  ~PlanCache() = default;
+
+  /**
+   * Get the plan of a shape for a table, resolving it on first use
+   * @param table table the query runs on
+   * @param fieldOperands operands that name fields
+   * @param conditions WHERE clause of the query
+   */
+  auto get(const Table &table, std::span<const std::string> fieldOperands,
+           const std::vector<QueryCondition> &conditions)
+      -> std::shared_ptr<const QueryPlan>;
+
+  // Forget every plan resolved against a schema (its table was dropped)
+  void dropSchema(std::uint64_t schemaId);
+
+private:
+  PlanCache() = default;
+
+  // A shape as stored in the cache
+  struct Shape {
+    std::size_t hash = 0;
+    std::uint64_t schemaId = 0;
+    std::vector<std::string> fields;
+    std::vector<std::pair<std::string, std::string>> conditions;
+  };
+
+  // A shape as looked up, viewing the strings of the query
+  struct ShapeRef {
+    std::size_t hash = 0;
+    std::uint64_t schemaId = 0;
+    std::span<const std::string> fields;
+    const std::vector<QueryCondition> *conditions = nullptr;
+  };
+
+  // Both key types carry their hash, computed once per lookup
+  struct ShapeHash {
+    using is_transparent = void;
+    auto operator()(const Shape &shape) const -> std::size_t {
+      return shape.hash;
+    }
+    auto operator()(const ShapeRef &shape) const -> std::size_t {
+      return shape.hash;
+    }
+  };
+
+  struct ShapeEqual {
+    using is_transparent = void;
+    auto operator()(const Shape &lhs, const Shape &rhs) const -> bool;
+    auto operator()(const ShapeRef &lhs, const Shape &rhs) const -> bool;
+    auto operator()(const Shape &lhs, const ShapeRef &rhs) const -> bool {
+      return (*this)(rhs, lhs);
+    }
+  };
+
+  using ShapeMap = std::unordered_map<Shape, std::shared_ptr<const QueryPlan>,
+                                      ShapeHash, ShapeEqual>;
+
+  struct Stripe {
+    std::shared_mutex mutex;
+    ShapeMap plans;
+  };
+
+  static constexpr std::size_t kStripes = 16;
+  std::array<Stripe, kStripes> stripes_;
+};
+
+#endif  // SRC_QUERY_QUERYPLAN_H_
@@ -5,7 +5,46 @@
 #include "QueryResult.h"
 
 #include <ostream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "../utils/TextWriter.h"
 
 auto operator<<(std::ostream &os, const QueryResult &table) -> std::ostream & {
   return table.output(os);
 }
+
+auto ErrorMsgResult::output(std::ostream &os) const -> std::ostream & {
+  os << "Query \"" << qname << "\" failed";
+  if (table.has_value()) {
+    os << " in Table \"" << *table << '"';
+  }
+  return os << " : " << msg << '\n';
+}
+
+auto SuccessMsgResult::output(std::ostream &os) const -> std::ostream & {
+  switch (form) {
+  case Form::Answer: {
+    IntDigits<int> digits{};
+    return os << "ANSWER = " << formatInt(digits, std::get<int>(payload))
+              << '\n';
+  }
+  case Form::Answers: {
+    IntDigits<int> digits{};
+    os << "ANSWER = ( ";
+    for (const int value : std::get<std::vector<int>>(payload)) {
+      os << formatInt(digits, value) << ' ';
+    }
+    return os << ")\n";
+  }
+  case Form::Done:
+    return os << "Query \"" << qname << "\" success.\n";
+  case Form::Text:
+    return os << std::get<std::string>(payload) << '\n';
+  case Form::QueryText:
+    return os << "Query \"" << qname
+              << "\" success : " << std::get<std::string>(payload) << '\n';
+  }
+  return os;
+}
@@ -5,14 +5,16 @@
 #ifndef SRC_QUERY_QUERYRESULT_H_
 #define SRC_QUERY_QUERYRESULT_H_
 
+#include <cstdint>
 #include <memory>
-#include <sstream>
+#include <optional>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
-#include "../utils/formatter.h"
-
 class QueryResult {
 public:
   using Ptr = std::unique_ptr<QueryResult>;
@@ -29,6 +31,11 @@ public:
 
   virtual auto display() -> bool = 0;
 
+  // Text printed before the query number, such as a SHOWTABLE dump
+  [[nodiscard]] virtual auto preamble() const -> std::string_view {
+    return {};
+  }
+
   virtual ~QueryResult() = default;
 
   friend auto operator<<(std::ostream &os,
@@ -39,9 +46,6 @@ protected:
 };
 
 class FailedQueryResult : public QueryResult {
-  // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes,misc-non-private-member-variables-in-classes)
-  std::string data;
-
 public:
   auto success() -> bool override { return false; }
 
@@ -62,55 +66,71 @@ protected:
   auto output(std::ostream &os) const -> std::ostream & override { return os; }
 };
 
+// Results keep their raw payload and are only formatted by `output`, so a
+// query allocates nothing beyond the result itself. Query names are the
+// static `qname` literals and are not copied.
 class ErrorMsgResult : public FailedQueryResult {
+  const char *qname;
+  std::optional<std::string> table;
   std::string msg;
 
 public:
-  ErrorMsgResult(const char *qname, const std::string &msg)
-      : msg(R"(Query "?" failed : ?)"_f % qname % msg) {}
+  ErrorMsgResult(const char *qname, std::string msg)
+      : qname(qname), msg(std::move(msg)) {}
 
-  ErrorMsgResult(const char *qname, const std::string &table,
-                 const std::string &msg)
-      : msg(R"(Query "?" failed in Table "?" : ?)"_f % qname % table % msg) {}
+  ErrorMsgResult(const char *qname, std::string table, std::string msg)
+      : qname(qname), table(std::move(table)), msg(std::move(msg)) {}
 
 protected:
-  auto output(std::ostream &os) const -> std::ostream & override {
-    return os << msg << "\n";
-  }
+  auto output(std::ostream &os) const -> std::ostream & override;
 };
 
 class SuccessMsgResult : public SucceededQueryResult {
-  std::string msg;
+  enum class Form : std::uint8_t {
+    Answer,     // ANSWER = <int>
+    Answers,    // ANSWER = ( <ints> )
+    Done,       // Query "<qname>" success.
+    Text,       // the text as is
+    QueryText,  // Query "<qname>" success : <text>
+  };
+
+  Form form;
+  const char *qname = nullptr;
+  std::variant<int, std::vector<int>, std::string> payload;
 
 public:
   explicit SuccessMsgResult(const int number)
-      : msg(R"(ANSWER = ?)"_f % number) {}
-
-  explicit SuccessMsgResult(const std::vector<int> &results) {
-    std::stringstream stream;
-    stream << "ANSWER = ( ";
-    for (auto result : results) {
-      stream << result << " ";
-    }
-    stream << ")";
-    this->msg = stream.str();
-  }
+      : form(Form::Answer), payload(number) {}
 
-  explicit SuccessMsgResult(const char *qname)
-      : msg(R"(Query "?" success.)"_f % qname) {}
+  explicit SuccessMsgResult(std::vector<int> results)
+      : form(Form::Answers), payload(std::move(results)) {}
 
-  explicit SuccessMsgResult(std::string msg) : msg(std::move(msg)) {}
+  explicit SuccessMsgResult(const char *qname)
+      : form(Form::Done), qname(qname) {}
 
-  SuccessMsgResult(const char *qname, const std::string &msg)
-      : msg(R"(Query "?" success : ?)"_f % qname % msg) {}
+  explicit SuccessMsgResult(std::string msg)
+      : form(Form::Text), payload(std::move(msg)) {}
 
-  SuccessMsgResult(const char *qname, const std::string &table,
-                   const std::string &msg)
-      : msg(R"(Query "?" success in Table "?" : ?)"_f % qname % table % msg) {}
+  SuccessMsgResult(const char *qname, std::string msg)
+      : form(Form::QueryText), qname(qname), payload(std::move(msg)) {}
 
 protected:
-  auto output(std::ostream &os) const -> std::ostream & override {
-    return os << msg << "\n";
+  auto output(std::ostream &os) const -> std::ostream & override;
+};
+
+// A success message whose listing (SHOWTABLE, LIST) is rendered at execution
+// time but printed with the result, so it keeps its place in the output
+class ListingResult : public SuccessMsgResult {
+  std::string listing;
+
+public:
+  template <typename... Args>
+  explicit ListingResult(std::string listing, Args &&...args)
+      : SuccessMsgResult(std::forward<Args>(args)...),
+        listing(std::move(listing)) {}
+
+  [[nodiscard]] auto preamble() const -> std::string_view override {
+    return listing;
   }
 };
 
@@ -122,7 +142,7 @@ public:
 
 protected:
   auto output(std::ostream &os) const -> std::ostream & override {
-    return os << "Affected ? rows."_f % affectedRows << "\n";
+    return os << "Affected " << affectedRows << " rows.\n";
   }
 };
 
@@ -27,16 +27,16 @@ auto AddQuery::execute() -> QueryResult::Ptr {
     auto &database = Database::getInstance();
     auto &table = database[this->targetTable];
 
-    dstId = table.getFieldIndex(this->operands.back());
+    dstId = operandIndex(table, this->operands.size() - 1);
     // count the number of sources (minus the last operand)
     const auto srcCount = this->operands.size() - 1;
     srcId.clear();
     srcId.reserve(srcCount);
     auto ids_view =
-        this->operands | std::ranges::views::take(srcCount) |
+        std::ranges::views::iota(std::size_t{0}, srcCount) |
         std::ranges::views::transform(
-            [&table](const std::string &fname) -> Table::FieldIndex {
-              return table.getFieldIndex(fname);
+            [this, &table](std::size_t pos) -> Table::FieldIndex {
+              return operandIndex(table, pos);
             });
     std::ranges::copy(ids_view, std::back_inserter(srcId));
 
@@ -30,10 +30,10 @@ auto MinQuery::execute() -> QueryResult::Ptr {
     fieldId.clear();
     fieldId.resize(this->operands.size());
     auto ids_view =
-        this->operands |
+        std::ranges::views::iota(std::size_t{0}, this->operands.size()) |
         std::ranges::views::transform(
-            [&table](const std::string &fname) -> Table::FieldIndex {
-              return table.getFieldIndex(fname);
+            [this, &table](std::size_t pos) -> Table::FieldIndex {
+              return operandIndex(table, pos);
             });
     std::ranges::copy(ids_view, fieldId.begin());
 
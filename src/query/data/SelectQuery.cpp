@@ -6,13 +6,15 @@
 #include <iterator>
 #include <memory>
 #include <ranges>
-#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "../../db/Database.h"
 #include "../../db/Table.h"
+#include "../../utils/TextWriter.h"
 #include "../../utils/formatter.h"
 #include "../../utils/uexception.h"
 #include "../QueryResult.h"
@@ -36,53 +38,61 @@ auto SelectQuery::execute() -> QueryResult::Ptr {
   }
 
   Database &database = Database::getInstance();
-  std::stringstream msg;
   try {
     auto &table = database[this->targetTable];
     std::string tmp;
     auto result = initCondition(table);
     if (result.second) {
-      // vector of line message, used to sort in ascending lexical order
-      std::vector<std::string> v_msg;
+      // line messages are formatted back to back into one buffer and
+      // located by (offset, length), used to sort in ascending lexical order
+      std::string rows;
+      std::vector<std::pair<std::size_t, std::size_t>> spans;
 
       // save the target field index in a vector (append, do not clear)
       auto ids_view =
-          this->operands | std::ranges::views::drop(1) |
+          std::ranges::views::iota(std::size_t{1}, operands_size) |
           std::ranges::views::transform(
-              [&table](const std::string &fname) -> Table::FieldIndex {
-                return table.getFieldIndex(fname);
+              [this, &table](std::size_t pos) -> Table::FieldIndex {
+                return operandIndex(table, pos);
               });
       std::ranges::copy(ids_view, std::back_inserter(this->fieldId));
 
-      // if condition satisfies, push line message to v_msg
+      // if condition satisfies, append line message to rows
       for (auto &&obj : table) {
         if (this->evalCondition(obj)) {
-          std::stringstream line_msg;
-          line_msg << "( " << obj.key();
+          const auto start = rows.size();
+          rows.append("( ");
+          rows.append(obj.key());
           for (auto fieldVal : fieldId) {
-            line_msg << " " << obj[fieldVal];
+            rows.push_back(' ');
+            appendInt(rows, obj[fieldVal]);
           }
-          line_msg << " )\n";
-          v_msg.push_back(line_msg.str());
+          rows.append(" )\n");
+          spans.emplace_back(start, rows.size() - start);
         }
       }
 
       // sort in ascending lexical order
+      std::vector<std::string_view> v_msg;
+      v_msg.reserve(spans.size());
+      for (const auto &[offset, length] : spans) {
+        v_msg.emplace_back(std::string_view(rows).substr(offset, length));
+      }
       std::ranges::sort(v_msg);
 
       // concat as a whole message
+      tmp.reserve(rows.size());
       for (const auto &line : v_msg) {
-        msg << line;
+        tmp.append(line);
       }
 
-      tmp = msg.str();
       if (!tmp.empty()) {
         tmp.pop_back();
       } else {
         return std::make_unique<NullQueryResult>();
       }
     }
-    return std::make_unique<SuccessMsgResult>(tmp);
+    return std::make_unique<SuccessMsgResult>(std::move(tmp));
   } catch (const TableNameNotFound &e) {
     return std::make_unique<ErrorMsgResult>(qname, this->targetTable, e.what());
   } catch (const TableFieldNotFound &e) {
@@ -1,12 +1,14 @@
 #include "SumQuery.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <exception>
 #include <memory>
 #include <ranges>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "../../db/Database.h"
@@ -39,10 +41,10 @@ auto SumQuery::execute() -> QueryResult::Ptr {
     fieldId.clear();
     fieldId.resize(this->operands.size());
     auto ids_view =
-        this->operands |
+        std::ranges::views::iota(std::size_t{0}, this->operands.size()) |
         std::ranges::views::transform(
-            [&table](const std::string &fname) -> Table::FieldIndex {
-              return table.getFieldIndex(fname);
+            [this, &table](std::size_t pos) -> Table::FieldIndex {
+              return operandIndex(table, pos);
             });
     std::ranges::copy(ids_view, fieldId.begin());
 
@@ -69,7 +71,7 @@ auto SumQuery::execute() -> QueryResult::Ptr {
     std::ranges::transform(sums, result_sums.begin(), [](int64_t val) -> int {
       return static_cast<int>(val);
     });
-    return std::make_unique<SuccessMsgResult>(result_sums);
+    return std::make_unique<SuccessMsgResult>(std::move(result_sums));
   } catch (const TableNameNotFound &e) {
     return std::make_unique<ErrorMsgResult>(qname, this->targetTable, e.what());
   } catch (const TableFieldNotFound &e) {
@@ -26,8 +26,8 @@ auto SwapQuery::execute() -> QueryResult::Ptr {
           "Invalid number of operands (? operands)."_f % operands.size());
     }
 
-    field1Id = table.getFieldIndex(this->operands[0]);
-    field2Id = table.getFieldIndex(this->operands[1]);
+    field1Id = operandIndex(table, 0);
+    field2Id = operandIndex(table, 1);
     auto result = initCondition(table);
     if (result.second) {
       // if fields are the same, only count as affected number
@@ -29,7 +29,7 @@ auto UpdateQuery::execute() -> QueryResult::Ptr {
     if (this->operands[0] == "KEY") {
       this->keyValue = this->operands[1];
     } else {
-      this->fieldId = table.getFieldIndex(this->operands[0]);
+      this->fieldId = operandIndex(table, 0);
       constexpr int dec = 10;
       this->fieldValue = static_cast<Table::ValueType>(
           strtol(this->operands[1].c_str(), nullptr, dec));
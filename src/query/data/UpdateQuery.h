@@ -5,6 +5,8 @@
 #ifndef SRC_QUERY_DATA_UPDATEQUERY_H_
 #define SRC_QUERY_DATA_UPDATEQUERY_H_
 
+#include <algorithm>
+#include <cstddef>
 #include <string>
 
 #include "../../db/Table.h"
@@ -18,6 +20,11 @@ class UpdateQuery : public ComplexQuery {
   Table::FieldIndex fieldId{};
   Table::KeyType keyValue;
 
+  // UPDATE ( field value ): only the first operand names a field
+  [[nodiscard]] auto fieldOperandCount() const -> std::size_t override {
+    return std::min<std::size_t>(1, operands.size());
+  }
+
 public:
   using ComplexQuery::ComplexQuery;
 
@@ -9,13 +9,16 @@
 #include <string>
 
 #include "../../db/Database.h"
+#include "../../query/QueryPlan.h"
 #include "../../query/QueryResult.h"
 #include "../../utils/uexception.h"
 
 auto DropTableQuery::execute() -> QueryResult::Ptr {
   Database &database = Database::getInstance();
   try {
+    const auto schemaId = database[this->targetTable].schemaId();
     database.dropTable(this->targetTable);
+    PlanCache::getInstance().dropSchema(schemaId);
     return std::make_unique<NullQueryResult>();
   } catch (const TableNameNotFound &) {
     return std::make_unique<ErrorMsgResult>(qname, targetTable,
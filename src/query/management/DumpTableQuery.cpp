@@ -8,20 +8,40 @@
 #include <fstream>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "../../db/Database.h"
+#include "../../db/DumpWriter.h"
+#include "../../db/Table.h"
+#include "../../db/TableSnapshot.h"
 #include "../../query/QueryResult.h"
 #include "../../utils/formatter.h"
 
 auto DumpTableQuery::execute() -> QueryResult::Ptr {
   const auto &database = Database::getInstance();
+  auto &writer = DumpWriter::getInstance();
   try {
-    std::ofstream outfile(this->fileName);
+    const bool binary = TableSnapshot::dumpAsBinary(this->fileName);
+    // An earlier background dump to the same file has to land first
+    writer.waitFor(this->fileName);
+    const auto mode = binary ? std::ios::out | std::ios::binary : std::ios::out;
+    std::ofstream outfile(this->fileName, mode);
     if (!outfile.is_open()) {
       return std::make_unique<ErrorMsgResult>(qname, "Cannot open file '?'"_f %
                                                          this->fileName);
     }
-    outfile << database[this->targetTable];
+    const auto &table = database[this->targetTable];
+    if (writer.enabled()) {
+      // Copy under the table lock, format and write on the dump thread
+      writer.submit(this->fileName, std::move(outfile),
+                    std::make_unique<Table>(table.name(), table), binary);
+      return std::make_unique<NullQueryResult>();
+    }
+    if (binary) {
+      TableSnapshot::write(outfile, table);
+    } else {
+      outfile << table;
+    }
     outfile.close();
     return std::make_unique<NullQueryResult>();
   } catch (const std::exception &e) {
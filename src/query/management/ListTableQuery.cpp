@@ -5,15 +5,18 @@
 #include "ListTableQuery.h"
 
 #include <memory>
+#include <sstream>
 #include <string>
+#include <utility>
 
 #include "../../db/Database.h"
 #include "../../query/QueryResult.h"
 
 auto ListTableQuery::execute() -> QueryResult::Ptr {
   Database &database = Database::getInstance();
-  database.printAllTable();
-  return std::make_unique<SuccessMsgResult>(qname);
+  std::ostringstream listing;
+  database.printAllTable(listing);
+  return std::make_unique<ListingResult>(std::move(listing).str(), qname);
 }
 
 auto ListTableQuery::toString() -> std::string { return "QUERY = LIST"; }
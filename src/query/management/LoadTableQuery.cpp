@@ -5,12 +5,13 @@
 #include "LoadTableQuery.h"
 
 #include <exception>
-#include <fstream>
 #include <memory>
 #include <string>
 
 #include "../../db/Database.h"
+#include "../../db/DumpWriter.h"
 #include "../../query/QueryResult.h"
+#include "../../utils/MappedFile.h"
 #include "../../utils/formatter.h"
 
 auto LoadTableQuery::execute() -> QueryResult::Ptr {
@@ -18,13 +19,14 @@ auto LoadTableQuery::execute() -> QueryResult::Ptr {
   // The reason of removing this line is that loadTableFromStream is a static
   // method.
   try {
-    std::ifstream infile(this->fileName);
-    if (!infile.is_open()) {
+    // The file may still be written by a background DUMP
+    DumpWriter::getInstance().waitFor(this->fileName);
+    MappedFile infile;
+    if (!infile.open(this->fileName)) {
       return std::make_unique<ErrorMsgResult>(qname, "Cannot open file '?'"_f %
                                                          this->fileName);
     }
-    Database::loadTableFromStream(infile, this->fileName);
-    infile.close();
+    Database::loadTableFromBuffer(infile.view(), this->fileName);
     return std::make_unique<NullQueryResult>();
   } catch (const std::exception &e) {
     return std::make_unique<ErrorMsgResult>(qname, e.what());
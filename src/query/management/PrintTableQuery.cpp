@@ -4,9 +4,10 @@
 
 #include "PrintTableQuery.h"
 
-#include <iostream>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <utility>
 
 #include "../../db/Database.h"
 #include "../../query/QueryResult.h"
@@ -16,13 +17,13 @@ auto PrintTableQuery::execute() -> QueryResult::Ptr {
   const auto &database = Database::getInstance();
   try {
     const auto &table = database[this->targetTable];
-    std::cout << "================\n";
-    std::cout << "TABLE = ";
-    std::cout << table;
-    std::cout << "================\n\n";  // previously, it is std::cout <<
-                                          // "================\n" << std::endl;
-    // I am not sure flush is needed or not here. Just keep "\n". Let's see.
-    return std::make_unique<SuccessMsgResult>(qname, this->targetTable);
+    std::ostringstream listing;
+    listing << "================\n";
+    listing << "TABLE = ";
+    listing << table;
+    listing << "================\n\n";
+    return std::make_unique<ListingResult>(std::move(listing).str(), qname,
+                                           this->targetTable);
   } catch (const TableNameNotFound &) {
     return std::make_unique<ErrorMsgResult>(qname, this->targetTable,
                                             std::string("No such table."));
@@ -0,0 +1,57 @@
+//
+// CpuAffinity implementation
+//
+
+#include "CpuAffinity.h"
+
+#include <cstddef>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+auto allowedCpus() -> std::vector<int> {
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return cpus;
+  }
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &allowed)) {
+      cpus.push_back(cpu);
+    }
+  }
+#endif
+  return cpus;
+}
+
+auto pinCurrentThread(std::size_t slot) -> bool {
+  const auto cpus = allowedCpus();
+  if (cpus.empty()) {
+    return false;
+  }
+  return pinCurrentThreadTo({cpus[slot % cpus.size()]});
+}
+
+auto pinCurrentThreadTo(const std::vector<int> &cpus) -> bool {
+#ifdef __linux__
+  cpu_set_t target;
+  CPU_ZERO(&target);
+  for (const int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &target);
+    }
+  }
+  if (CPU_COUNT(&target) == 0) {
+    return false;
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(target), &target) == 0;
+#else
+  static_cast<void>(cpus);
+  return false;
+#endif
+}
@@ -0,0 +1,23 @@
+//
+// CpuAffinity - pin threads to CPUs
+//
+
+#ifndef SRC_RUNTIME_CPUAFFINITY_H_
+#define SRC_RUNTIME_CPUAFFINITY_H_
+
+#include <cstddef>
+#include <vector>
+
+// CPUs the calling thread may run on, in ascending order; empty where this
+// is not supported
+auto allowedCpus() -> std::vector<int>;
+
+// Pin the calling thread to the `slot`-th CPU it may run on (wrapping
+// around); returns false where pinning is not supported or fails
+auto pinCurrentThread(std::size_t slot) -> bool;
+
+// Let the calling thread run on any of `cpus`; threads it starts inherit
+// the set
+auto pinCurrentThreadTo(const std::vector<int> &cpus) -> bool;
+
+#endif  // SRC_RUNTIME_CPUAFFINITY_H_
@@ -0,0 +1,111 @@
+//
+// DataflowExecutor implementation
+//
+
+#include "DataflowExecutor.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "../query/QueryResult.h"
+#include "../scheduler/BatchPlan.h"
+#include "../scheduler/CatalogLog.h"
+
+DataflowExecutor::DataflowExecutor(std::size_t numThreads, BatchPlan &plan)
+    : plan_(plan), pending_(plan.size()), remaining_(plan.size()) {
+  const std::vector<BatchPlan::NodeId> roots = plan_.finalize();
+  for (std::size_t index = 0; index < plan_.size(); ++index) {
+    const BatchPlan::Node &node =
+        plan_.node(static_cast<BatchPlan::NodeId>(index));
+    pending_[index].store(node.predecessors, std::memory_order_relaxed);
+    if (node.query->type() == QueryType::List) {
+      catalog_.expect(index);
+    }
+  }
+  for (const BatchPlan::NodeId root : roots) {
+    ready_.push({plan_.node(root).rank, root});
+  }
+  threads_.reserve(numThreads);
+  for (std::size_t i = 0; i < numThreads; ++i) {
+    threads_.emplace_back([this]() { work(); });
+  }
+}
+
+DataflowExecutor::~DataflowExecutor() {
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void DataflowExecutor::work() {
+  std::vector<Ready> released;
+  while (true) {
+    BatchPlan::NodeId index = 0;
+    {
+      std::unique_lock lock(mutex_);
+      wake_.wait(lock, [this]() { return !ready_.empty() || remaining_ == 0; });
+      if (ready_.empty()) {
+        return;  // every node has finished
+      }
+      index = ready_.top().index;
+      ready_.pop();
+    }
+
+    released.clear();
+    run(index, released);
+
+    bool finished = false;
+    {
+      std::lock_guard lock(mutex_);  // NOLINT(misc-const-correctness)
+      for (const Ready &next : released) {
+        ready_.push(next);
+      }
+      finished = --remaining_ == 0;
+    }
+    if (finished) {
+      wake_.notify_all();
+      return;
+    }
+    // This worker takes one of the released nodes itself
+    for (std::size_t woken = 1; woken < released.size(); ++woken) {
+      wake_.notify_one();
+    }
+  }
+}
+
+void DataflowExecutor::run(BatchPlan::NodeId index,
+                           std::vector<Ready> &released) {
+  BatchPlan::Node &node = plan_.node(index);
+  const QueryType type = node.query->type();
+  if (type == QueryType::List) {
+    // A barrier: every earlier node has recorded its table
+    node.result->publishFrom([this, index]() -> QueryResult::Ptr {
+      const std::lock_guard lock(catalogMutex_);
+      return std::make_unique<ListingResult>(catalog_.list(index), "LIST");
+    });
+  } else {
+    node.result->publishFrom(
+        [&node]() -> QueryResult::Ptr { return node.query->execute(); });
+  }
+  if (CatalogLog::tracks(type)) {
+    // No other node touches the table while this write runs
+    const std::string &table = type == QueryType::CopyTable
+                                   ? node.query->newTable()
+                                   : node.query->table();
+    const TableStats stats = CatalogLog::snapshot(table);
+    const std::lock_guard lock(catalogMutex_);
+    catalog_.record(index, type, table, stats);
+  }
+  node.query.reset();
+
+  for (const BatchPlan::NodeId next : node.successors) {
+    if (pending_[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      released.push_back({plan_.node(next).rank, next});
+    }
+  }
+}
@@ -0,0 +1,72 @@
+//
+// DataflowExecutor - runs a BatchPlan
+// Every node keeps an atomic count of unfinished predecessors. A worker that
+// finishes a node decrements the counts of its successors and queues those
+// that reach zero, so dependencies cost no lookups at run time. Ready nodes
+// are taken in order of their critical path rank, then sequence. Conflicting
+// queries are ordered by the plan, so no table locks are taken. LIST is
+// answered from a CatalogLog, which lists tables in single-threaded order
+// however parallel LOADs filled the Database.
+//
+
+#ifndef SRC_RUNTIME_DATAFLOWEXECUTOR_H_
+#define SRC_RUNTIME_DATAFLOWEXECUTOR_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "../scheduler/BatchPlan.h"
+#include "../scheduler/CatalogLog.h"
+
+class DataflowExecutor {
+public:
+  // Start `numThreads` workers on a finalized plan
+  DataflowExecutor(std::size_t numThreads,
+                   BatchPlan &plan);  // NOLINT(runtime/references)
+
+  // Waits until every node has run
+  ~DataflowExecutor();
+
+  DataflowExecutor(const DataflowExecutor &) = delete;
+  auto operator=(const DataflowExecutor &) -> DataflowExecutor & = delete;
+  DataflowExecutor(DataflowExecutor &&) = delete;
+  auto operator=(DataflowExecutor &&) -> DataflowExecutor & = delete;
+
+private:
+  struct Ready {
+    std::uint64_t rank;
+    BatchPlan::NodeId index;
+
+    // Longer critical path first, then the earlier query
+    auto operator<(const Ready &other) const -> bool {
+      return rank != other.rank ? rank < other.rank : index > other.index;
+    }
+  };
+
+  void work();
+
+  // Run one node and release the successors it was the last to wait for
+  void run(BatchPlan::NodeId index,
+           std::vector<Ready> &released);  // NOLINT(runtime/references)
+
+  BatchPlan &plan_;
+  std::vector<std::atomic<std::uint32_t>> pending_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::priority_queue<Ready> ready_;
+  std::size_t remaining_;  // nodes that have not finished
+
+  std::mutex catalogMutex_;
+  CatalogLog catalog_;  // guarded by catalogMutex_
+
+  std::vector<std::thread> threads_;
+};
+
+#endif  // SRC_RUNTIME_DATAFLOWEXECUTOR_H_
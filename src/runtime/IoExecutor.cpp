@@ -0,0 +1,62 @@
+//
+// IoExecutor implementation
+//
+
+#include "IoExecutor.h"
+
+#include <cstddef>
+#include <mutex>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "../query/Query.h"
+#include "../scheduler/TaskQueue.h"
+
+IoExecutor::IoExecutor(std::size_t numThreads, Handler handler)
+    : handler_(std::move(handler)) {
+  threads_.reserve(numThreads);
+  for (std::size_t i = 0; i < numThreads; ++i) {
+    threads_.emplace_back([this] { this->loop(); });
+  }
+}
+
+IoExecutor::~IoExecutor() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto &thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+auto IoExecutor::handles(const ExecutableTask &task) -> bool {
+  return task.query != nullptr &&
+         (task.type == QueryType::Load || task.type == QueryType::Dump);
+}
+
+void IoExecutor::post(ExecutableTask &&task) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  wake_.notify_one();
+}
+
+void IoExecutor::loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+    if (tasks_.empty()) {
+      return;  // stopping with nothing left to run
+    }
+    ExecutableTask task = std::move(tasks_.front());
+    tasks_.pop_front();
+    lock.unlock();
+    handler_(task);
+    lock.lock();
+  }
+}
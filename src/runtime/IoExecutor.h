@@ -0,0 +1,55 @@
+//
+// IoExecutor
+// A separately sized set of threads for file I/O queries (LOAD/DUMP). Compute
+// workers hand such tasks over after fetching them, so a burst of large file
+// operations cannot occupy every compute worker. Tasks are run through the
+// same handler as on the compute workers (same locks, same completion
+// callbacks), so the TaskQueue dependency logic is unaffected.
+//
+
+#ifndef SRC_RUNTIME_IOEXECUTOR_H_
+#define SRC_RUNTIME_IOEXECUTOR_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "../scheduler/TaskQueue.h"
+
+class IoExecutor {
+public:
+  using Handler = std::function<void(ExecutableTask &)>;
+
+  IoExecutor(std::size_t numThreads, Handler handler);
+
+  // Runs every task already posted, then joins the threads
+  ~IoExecutor();
+
+  IoExecutor(const IoExecutor &) = delete;
+  IoExecutor(IoExecutor &&) = delete;
+  auto operator=(const IoExecutor &) -> IoExecutor & = delete;
+  auto operator=(IoExecutor &&) -> IoExecutor & = delete;
+
+  // Whether a fetched task should be handed to the I/O threads
+  [[nodiscard]] static auto handles(const ExecutableTask &task) -> bool;
+
+  void post(ExecutableTask &&task);
+
+  [[nodiscard]] auto size() const -> std::size_t { return threads_.size(); }
+
+private:
+  void loop();
+
+  Handler handler_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<ExecutableTask> tasks_;
+  bool stopping_{false};
+  std::vector<std::thread> threads_;
+};
+
+#endif  // SRC_RUNTIME_IOEXECUTOR_H_
@@ -0,0 +1,74 @@
+//
+// NumaTopology implementation
+//
+
+#include "NumaTopology.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "CpuAffinity.h"
+
+namespace {
+const std::string kNodeRoot = "/sys/devices/system/node/";
+
+// Parse a sysfs list such as "0-3,8-11"; empty on malformed input
+auto parseList(std::string_view text) -> std::vector<int> {
+  std::vector<int> values;
+  while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+    text.remove_suffix(1);
+  }
+  while (!text.empty()) {
+    const auto comma = text.find(',');
+    const auto range = text.substr(0, comma);
+    text = comma == std::string_view::npos ? std::string_view{}
+                                           : text.substr(comma + 1);
+    int first = 0;
+    const auto *end = range.data() + range.size();
+    auto parsed = std::from_chars(range.data(), end, first);
+    int last = first;
+    if (parsed.ec == std::errc{} && parsed.ptr != end && *parsed.ptr == '-') {
+      parsed = std::from_chars(parsed.ptr + 1, end, last);
+    }
+    if (parsed.ec != std::errc{} || parsed.ptr != end || last < first) {
+      return {};
+    }
+    for (int value = first; value <= last; ++value) {
+      values.push_back(value);
+    }
+  }
+  return values;
+}
+
+auto readList(const std::string &path) -> std::vector<int> {
+  std::ifstream file(path);
+  std::string line;
+  if (!file || !std::getline(file, line)) {
+    return {};
+  }
+  return parseList(line);
+}
+}  // namespace
+
+auto NumaTopology::detect() -> NumaTopology {
+  NumaTopology topology;
+  const auto allowed = allowedCpus();
+  for (const int node : readList(kNodeRoot + "online")) {
+    auto cpus = readList(kNodeRoot + "node" + std::to_string(node) +
+                         "/cpulist");
+    std::erase_if(cpus, [&allowed](int cpu) {
+      return !std::binary_search(allowed.begin(), allowed.end(), cpu);
+    });
+    if (!cpus.empty()) {
+      topology.nodes.push_back(std::move(cpus));
+    }
+  }
+  return topology;
+}
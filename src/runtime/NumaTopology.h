@@ -0,0 +1,26 @@
+//
+// NumaTopology - NUMA nodes and their CPUs, read from sysfs
+// Workers are dealt to the nodes in turn, so worker i runs on node
+// i % nodeCount(); TaskQueue uses the same rule to find a table's home node.
+//
+
+#ifndef SRC_RUNTIME_NUMATOPOLOGY_H_
+#define SRC_RUNTIME_NUMATOPOLOGY_H_
+
+#include <cstddef>
+#include <vector>
+
+struct NumaTopology {
+  // CPUs of every online node that has CPUs this process may run on
+  std::vector<std::vector<int>> nodes;
+
+  // Read /sys/devices/system/node; no nodes where that is unavailable
+  static auto detect() -> NumaTopology;
+
+  [[nodiscard]] auto nodeCount() const -> std::size_t { return nodes.size(); }
+  [[nodiscard]] auto nodeOfWorker(std::size_t worker) const -> std::size_t {
+    return nodes.empty() ? 0 : worker % nodes.size();
+  }
+};
+
+#endif  // SRC_RUNTIME_NUMATOPOLOGY_H_
@@ -5,186 +5,255 @@
 #include "QueryExecutor.h"
 
 #include <cstddef>
-#include <cstdio>
 #include <exception>
-#include <fstream>
 #include <iostream>
-#include <iterator>
 #include <memory>
+#include <optional>
 #include <queue>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "../query/Query.h"
+#include "../query/QueryChunks.h"
 #include "../query/QueryParser.h"
 #include "../query/QueryResult.h"
 #include "../query/management/ListenQuery.h"
 #include "../utils/FallbackAnalyzer.h"
+#include "../utils/MappedFile.h"
+#include "../utils/OutputWriter.h"
 #include "../utils/uexception.h"
+#include "ResultStream.h"
 #include "Runtime.h"
 
-auto extractQueryString(std::istream &input_stream) -> std::string {
-  std::string buf;
-  while (true) {
-    int const char_read = input_stream.get();
-    if (char_read == ';') {
-      return buf;
-    }
-    if (char_read == EOF) {
-      throw std::ios_base::failure("End of input");
-    }
-    buf.push_back(static_cast<char>(char_read));
+auto extractQueryString(std::string_view &input)
+    -> std::optional<std::string_view> {
+  const std::size_t end = input.find(';');
+  if (end == std::string_view::npos) {
+    return std::nullopt;  // a trailing unterminated query is discarded
   }
+  const std::string_view queryStr = input.substr(0, end);
+  input.remove_prefix(end + 1);
+  return queryStr;
 }
 
 void outputQueryResult(size_t queryNum, const QueryResult::Ptr &result) {
-  std::cout << queryNum << "\n";
+  OutputWriter &writer = OutputWriter::getInstance();
+  writer.out() << result->preamble() << queryNum << "\n";
   if (result->success()) {
     if (result->display()) {
-      std::cout << *result;
+      writer.out() << *result;
     } else {
-      std::cout.flush();
-      std::cerr << *result;
+      writer.err() << *result;
     }
   } else {
-    std::cout.flush();
-    std::cerr << "QUERY FAILED:\n\t" << *result;
+    writer.err() << "QUERY FAILED:\n\t" << *result;
   }
+  writer.endOfResult();
 }
 
 namespace {
-struct FileProcessResult {
-  std::vector<Query::Ptr> queries;
-  std::vector<std::string> listenFiles;
-};
-
-auto processFile(const std::string &filename,
-                 QueryParser &parser)  // NOLINT(runtime/references)
-    -> FileProcessResult {
-  FileProcessResult result;
-
-  std::ifstream fin(filename);
-  if (!fin.is_open()) {
-    std::cerr << "Error: could not open " << filename << "\n";
-    return result;
-  }
-
-  std::istream &input_stream = fin;
-
-  while (input_stream) {
-    try {
-      std::string const queryStr = extractQueryString(input_stream);
-      Query::Ptr query = parser.parseQuery(queryStr);
+// Hand one query to `sink`, parsing it first if `query` is null
+template <typename Sink>
+void emitQuery(Query::Ptr query, std::string_view queryStr,
+               QueryParser &parser,                 // NOLINT
+               std::queue<std::string> &fileQueue,  // NOLINT
+               Sink &sink) {                        // NOLINT
+  try {
+    if (query == nullptr) {
+      query = parser.parseQuery(queryStr);
+    }
 
-      const auto *listenQuery = dynamic_cast<const ListenQuery *>(query.get());
-      if (listenQuery != nullptr) {
-        result.listenFiles.push_back(listenQuery->getFileName());
-      }
-      result.queries.push_back(std::move(query));
-    } catch (const std::ios_base::failure &) {
-      break;
-    } catch (const std::exception &exception_obj) {
-      std::cout.flush();
-      std::cerr << exception_obj.what() << '\n';
+    const auto *listenQuery = dynamic_cast<const ListenQuery *>(query.get());
+    if (listenQuery != nullptr) {
+      fileQueue.push(listenQuery->getFileName());
     }
+    sink(std::move(query));
+  } catch (const std::exception &exception_obj) {
+    std::cerr << exception_obj.what() << '\n';
   }
-  return result;
 }
-}  // namespace
 
-// Helper: Collect queries from input stream
-namespace {
-void collectQueriesFromStream(std::istream &input_stream,            // NOLINT
-                              QueryParser &parser,                   // NOLINT
-                              std::vector<Query::Ptr> &allQueries,   // NOLINT
-                              std::queue<std::string> &fileQueue) {  // NOLINT
-  while (input_stream) {
-    try {
-      std::string const queryStr = extractQueryString(input_stream);
-      Query::Ptr query = parser.parseQuery(queryStr);
-
-      const auto *listenQuery = dynamic_cast<const ListenQuery *>(query.get());
-      if (listenQuery != nullptr) {
-        fileQueue.push(listenQuery->getFileName());
-      }
-      allQueries.push_back(std::move(query));
-    } catch (const std::ios_base::failure &) {
-      break;
-    } catch (const std::exception &exception_obj) {
-      std::cout.flush();
-      std::cerr << exception_obj.what() << '\n';
+// Parse every query of one buffer in order, handing each to `sink`. Large
+// buffers are parsed chunk by chunk in parallel; chunks are consumed in order
+// as they complete, so sequence numbers and LISTEN order are unchanged.
+template <typename Sink>
+void parseStream(std::string_view input,
+                 QueryParser &parser,                 // NOLINT
+                 std::queue<std::string> &fileQueue,  // NOLINT
+                 Sink &sink) {                        // NOLINT
+  auto chunks = parseChunksAsync(input);
+  if (chunks.empty()) {
+    while (auto queryStr = extractQueryString(input)) {
+      emitQuery(nullptr, *queryStr, parser, fileQueue, sink);
+    }
+    return;
+  }
+  for (auto &chunk : chunks) {
+    for (auto &entry : chunk.get()) {
+      emitQuery(std::move(entry.query), entry.deferred, parser, fileQueue,
+                sink);
     }
   }
 }
-}  // namespace
 
-// NOLINTNEXTLINE(readability-function-cognitive-complexity)
-void executeQueries(std::istream &input_stream,
-                    [[maybe_unused]] std::ifstream &fin,
-                    QueryParser &parser,  // NOLINT
-                    size_t numThreads) {
-  size_t counter = 0;
+// Parse the input, then every LISTEN file breadth-first. Each file is mapped
+// only while it is parsed since queries keep copies of what they need.
+template <typename Sink>
+void parseAll(std::string_view input,
+              QueryParser &parser,  // NOLINT
+              Sink &sink) {         // NOLINT
   std::queue<std::string> fileQueue;
-  std::vector<Query::Ptr> allQueries;
-
-  // Collect queries from initial stream
-  collectQueriesFromStream(input_stream, parser, allQueries, fileQueue);
+  parseStream(input, parser, fileQueue, sink);
 
   while (!fileQueue.empty()) {
     const std::string filename = fileQueue.front();
     fileQueue.pop();
 
-    auto fileResult = processFile(filename, parser);
+    MappedFile file;
+    if (!file.open(filename)) {
+      std::cerr << "Error: could not open " << filename << "\n";
+      continue;
+    }
+    parseStream(file.view(), parser, fileQueue, sink);
+  }
+}
+
+// Receives parsed queries in order. Queries are buffered until the fallback
+// decision can be taken; once the cost model picks more than one worker the
+// runtime starts and every further query is submitted as soon as it is
+// parsed, while a ResultStream prints the results in order. The decision is
+// revisited every kDecisionInterval queries, and once more when parsing is
+// done. The rest of the input may be worth more workers than the prefix, so
+// the runtime gets all of them with only the chosen ones active, and
+// WorkerScaler wakes the others when tables wait. A batch plan needs every
+// query, so then the runtime only starts once parsing is done, with the
+// chosen worker count.
+class QueryPipeline {
+public:
+  static constexpr size_t kDecisionInterval = 1024;
 
-    allQueries.insert(allQueries.end(),
-                      std::make_move_iterator(fileResult.queries.begin()),
-                      std::make_move_iterator(fileResult.queries.end()));
+  QueryPipeline(size_t numThreads, const RuntimeOptions &options)
+      : numThreads_(numThreads), options_(options),
+        costs_(numThreads > 1 ? calibrateCosts() : CostCalibration{}),
+        tracker_(options.batchPlan) {}
 
-    for (const auto &listenFile : fileResult.listenFiles) {
-      fileQueue.push(listenFile);
+  void operator()(Query::Ptr query) {
+    if (runtime_ != nullptr) {
+      runtime_->submitQuery(std::move(query), ++counter_);
+      return;
+    }
+    tracker_.add(*query);
+    buffered_.push_back(std::move(query));
+    // The statistics only grow, so a prefix that is worth several workers
+    // makes the whole input worth at least as many
+    if (!options_.batchPlan && buffered_.size() % kDecisionInterval == 0) {
+      startIfWorthIt();
     }
   }
 
-  // Analyze workload and decide fallback
-  size_t effectiveThreads = numThreads;
-  if (numThreads > 1) {
-    const WorkloadStats stats = analyzeWorkload(allQueries);
-    const FallbackThresholds thresholds;  // Use default thresholds
+  // Run whatever has not been started yet and print the remaining results
+  void finish() {
+    if (runtime_ == nullptr) {
+      startIfWorthIt();
+    }
+    if (runtime_ == nullptr) {
+      runSingleThreaded();
+      return;
+    }
+    output_->finish();
+  }
 
-    if (shouldFallback(numThreads, stats, thresholds)) {
-      effectiveThreads = 1;
-      std::cerr << "Falling back to single-threaded mode (low workload: "
-                << stats.queryCount << " queries, " << stats.tableCount
-                << " tables)\n";
+private:
+  void startIfWorthIt() {
+    if (numThreads_ <= 1) {
+      return;
+    }
+    const size_t workers =
+        chooseWorkerCount(numThreads_, tracker_.stats(), costs_);
+    if (workers > 1) {
+      startRuntime(workers);
     }
   }
 
-  // Execute queries based on effective thread count
-  if (effectiveThreads == 1) {
-    // Single-threaded execution
-    for (auto &query : allQueries) {
-      ++counter;
-      auto result = query->execute();
-      outputQueryResult(counter, result);
+  void startRuntime(size_t workers) {
+    if (options_.batchPlan) {
+      runtime_ = std::make_unique<Runtime>(workers, options_);
+    } else {
+      RuntimeOptions options = options_;
+      options.activeWorkers = workers;
+      runtime_ = std::make_unique<Runtime>(numThreads_, options);
     }
-  } else {
-    // Multi-threaded execution - create Runtime with effective threads
-    Runtime runtime(effectiveThreads);
+    for (auto &pending : buffered_) {
+      runtime_->submitQuery(std::move(pending), ++counter_);
+    }
+    buffered_.clear();
+    runtime_->startExecution();
+    output_ = std::make_unique<ResultStream>(*runtime_);
+  }
 
-    for (auto &query : allQueries) {
-      ++counter;
-      runtime.submitQuery(std::move(query), counter);
+  void runSingleThreaded() {
+    if (numThreads_ > 1) {
+      reportFallback();
     }
+    for (auto &query : buffered_) {
+      ++counter_;
+      auto result = query->execute();
+      outputQueryResult(counter_, result);
+    }
+  }
 
-    runtime.startExecution();
-    runtime.waitAll();
-    auto results = runtime.getResultsInOrder();
-    for (size_t i = 0; i < results.size(); ++i) {
-      if (results[i] == nullptr) {
-        throw QuitException();
+  // Tell why the cost model kept one worker: its best estimate with several
+  // workers against the single-threaded one
+  void reportFallback() const {
+    const WorkloadStats stats = tracker_.stats();
+    size_t workers = 2;
+    double parallel = estimateRunNanos(workers, stats, costs_);
+    for (size_t count = 3; count <= numThreads_; ++count) {
+      const double nanos = estimateRunNanos(count, stats, costs_);
+      if (nanos < parallel) {
+        workers = count;
+        parallel = nanos;
       }
-      outputQueryResult(i + 1, results[i]);
     }
+    const auto micros = [](double nanos) {
+      return static_cast<size_t>(nanos / 1000);
+    };
+    std::cerr << "Falling back to single-threaded mode (estimated "
+              << micros(estimateRunNanos(1, stats, costs_))
+              << " us single-threaded, " << micros(parallel) << " us on "
+              << workers << " workers";
+    if (costs_.cores < workers) {
+      std::cerr << " sharing " << costs_.cores
+                << (costs_.cores == 1 ? " core" : " cores");
+    }
+    std::cerr << "; " << stats.queryCount << " queries, " << stats.tableCount
+              << " tables, ~" << static_cast<size_t>(stats.work)
+              << " rows of work)\n";
+  }
+
+  size_t numThreads_;
+  RuntimeOptions options_;
+  const CostCalibration costs_;  // measured once at startup
+  WorkloadTracker tracker_;
+  std::vector<Query::Ptr> buffered_;
+  std::unique_ptr<Runtime> runtime_;
+  std::unique_ptr<ResultStream> output_;  // prints while queries still run
+  size_t counter_ = 0;
+};
+}  // namespace
+
+void executeQueries(std::string_view input,
+                    QueryParser &parser,  // NOLINT
+                    size_t numThreads, const RuntimeOptions &options) {
+  QueryPipeline pipeline(numThreads, options);
+  parseAll(input, parser, pipeline);
+  try {
+    pipeline.finish();
+  } catch (...) {
+    OutputWriter::getInstance().flush();  // results printed before QUIT
+    throw;
   }
+  OutputWriter::getInstance().flush();
 }
@@ -6,18 +6,22 @@
 #define SRC_RUNTIME_QUERYEXECUTOR_H_
 
 #include <cstddef>
-#include <fstream>
-#include <istream>
-#include <string>
+#include <optional>
+#include <string_view>
 
 #include "../query/QueryParser.h"
+#include "Runtime.h"
 
-auto extractQueryString(std::istream &input_stream) -> std::string;
+// Split the next ';'-terminated query off the front of `input`
+auto extractQueryString(std::string_view &input)  // NOLINT(runtime/references)
+    -> std::optional<std::string_view>;
 
 void outputQueryResult(size_t queryNum, const QueryResult::Ptr &result);
 
-void executeQueries(std::istream &input_stream, std::ifstream &fin,
+// `input` is the listened file's text; LISTEN files are mapped on demand
+void executeQueries(std::string_view input,
                     QueryParser &parser,  // NOLINT(runtime/references)
-                    size_t numThreads);
+                    size_t numThreads,
+                    const RuntimeOptions &options = RuntimeOptions{});
 
 #endif  // SRC_RUNTIME_QUERYEXECUTOR_H_
@@ -0,0 +1,58 @@
+//
+// ResultStream implementation
+//
+
+#include "ResultStream.h"
+
+#include <cstddef>
+#include <exception>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "../utils/OutputWriter.h"
+#include "../utils/uexception.h"
+#include "QueryExecutor.h"
+#include "Runtime.h"
+
+ResultStream::ResultStream(Runtime &runtime)
+    : runtime_(runtime), thread_([this]() { run(); }) {}
+
+ResultStream::~ResultStream() {
+  if (thread_.joinable()) {
+    runtime_.closeSubmission();
+    thread_.join();
+  }
+}
+
+void ResultStream::finish() {
+  runtime_.closeSubmission();
+  thread_.join();
+  OutputWriter::getInstance().flush();
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+  if (quit_.load()) {
+    throw QuitException();
+  }
+}
+
+void ResultStream::run() {
+  try {
+    for (std::size_t index = 1;; ++index) {
+      if (!runtime_.resultReady(index)) {
+        // let consumers see what is complete so far
+        OutputWriter::getInstance().idle();
+      }
+      auto result = runtime_.takeResult(index);
+      if (!result) {
+        return;  // every submitted query has been printed
+      }
+      if (*result == nullptr) {
+        quit_.store(true);
+        return;
+      }
+      outputQueryResult(index, *result);
+    }
+  } catch (...) {
+    error_ = std::current_exception();
+  }
+}
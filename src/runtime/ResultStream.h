@@ -0,0 +1,43 @@
+//
+// ResultStream - in-order output of multi-threaded results
+// An output thread takes results from the Runtime by sequence number and
+// prints result i as soon as results 1..i are complete. Output accumulates in
+// the OutputWriter, which is told whenever the next result is not ready yet,
+// so consumers see results while later queries are still running and only
+// results waiting for an earlier one are held in memory.
+//
+
+#ifndef SRC_RUNTIME_RESULTSTREAM_H_
+#define SRC_RUNTIME_RESULTSTREAM_H_
+
+#include <atomic>
+#include <exception>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "Runtime.h"
+
+class ResultStream {
+public:
+  explicit ResultStream(Runtime &runtime);
+
+  // Closes submission and waits for the output thread
+  ~ResultStream();
+
+  ResultStream(const ResultStream &) = delete;
+  auto operator=(const ResultStream &) -> ResultStream & = delete;
+  ResultStream(ResultStream &&) = delete;
+  auto operator=(ResultStream &&) -> ResultStream & = delete;
+
+  // Print every remaining result, throws QuitException if QUIT was reached
+  void finish();
+
+private:
+  void run();
+
+  Runtime &runtime_;
+  std::atomic<bool> quit_{false};
+  std::exception_ptr error_;
+  std::thread thread_;
+};
+
+#endif  // SRC_RUNTIME_RESULTSTREAM_H_
@@ -4,33 +4,66 @@
 
 #include "Runtime.h"
 
+#include <atomic>
 #include <cstddef>
-#include <exception>
-#include <future>
+#include <cstdint>
 #include <iostream>
 #include <memory>
-#include <mutex>
-#include <string>
+#include <optional>
 #include <utility>
-#include <vector>
 
 #include "../query/Query.h"
 #include "../query/QueryHelpers.h"
 #include "../query/QueryPriority.h"
 #include "../query/QueryResult.h"
+#include "../scheduler/BatchPlan.h"
+#include "../scheduler/ResultSlots.h"
 #include "../scheduler/TaskQueue.h"
-#include "../utils/uexception.h"
+#include "DataflowExecutor.h"
 #include "LockManager.h"
+#include "NumaTopology.h"
 #include "Threadpool.h"
 
-Runtime::Runtime(std::size_t numThreads)
-    : lockMgr_(std::make_unique<LockManager>()),
-      taskQueue_(std::make_unique<TaskQueue>()),
-      threadpool_(
-          std::make_unique<Threadpool>(numThreads, *lockMgr_, *taskQueue_)) {
+Runtime::Runtime(std::size_t numThreads, const RuntimeOptions &options)
+    : lockMgr_(std::make_unique<LockManager>()), numThreads_(numThreads) {
+  const bool affinity = options.affinity || options.numa;
+  NumaTopology numa;
+  if (options.numa && !options.batchPlan) {
+    numa = NumaTopology::detect();
+    if (numa.nodeCount() <= 1) {
+      numa.nodes.clear();
+    }
+  }
+  taskQueue_ = std::make_unique<TaskQueue>(options.tableOrder,
+                                           affinity ? numThreads : 0,
+                                           numa.nodeCount(), options.actors);
   // Runtime is only used in multi-threaded mode (numThreads > 1)
   std::cerr << "lemondb: info: multi-threaded mode enabled (" << numThreads
-            << " workers)\n";
+            << " workers";
+  if (options.batchPlan) {
+    plan_ = std::make_unique<BatchPlan>();
+    std::cerr << ", batch plan";
+  } else {
+    const std::size_t nodes = numa.nodeCount();
+    threadpool_ = std::make_unique<Threadpool>(
+        numThreads, options.ioThreads, *lockMgr_, *taskQueue_, affinity,
+        std::move(numa), options.actors, options.activeWorkers);
+    if (options.activeWorkers != 0 && options.activeWorkers < numThreads) {
+      std::cerr << ", " << options.activeWorkers << " active";
+    }
+    if (options.ioThreads > 0) {
+      std::cerr << ", " << options.ioThreads << " I/O threads";
+    }
+    if (nodes > 1) {
+      std::cerr << ", table affinity on " << nodes << " NUMA nodes";
+    } else if (affinity) {
+      std::cerr << ", table affinity";
+    }
+    if (options.actors) {
+      std::cerr << ", table actors";
+    }
+  }
+  std::cerr << ")\n";
 }
 
 Runtime::~Runtime() {
@@ -39,8 +72,6 @@ Runtime::~Runtime() {
 }
 
 void Runtime::submitQuery(Query::Ptr query, std::size_t orderIndex) {
-  ++totalSubmitted_;
-
   // Get query type before moving query
   const QueryType qtype = queryType(*query);
 
@@ -51,54 +82,57 @@ void Runtime::submitQuery(Query::Ptr query, std::size_t orderIndex) {
   pqueue.type = qtype;
   pqueue.priority = classifyPriority(qtype);
   pqueue.query = std::move(query);
-  pqueue.promise =
-      std::promise<std::unique_ptr<QueryResult>>();  // Runtime creates promise
-
-  // TaskQueue will get_future() from promise before moving it
-  auto future = taskQueue_->registerTask(std::move(pqueue));
+  pqueue.result = &slots_.claim(orderIndex);
 
-  // Store future for later retrieval
-  {
-    std::lock_guard lock(futuresMtx_);  // NOLINT(misc-const-correctness)
-    futures_[orderIndex] = std::move(future);
+  if (plan_ != nullptr) {
+    plan_->add(std::move(pqueue.query), *pqueue.result);
+  } else {
+    taskQueue_->registerTask(std::move(pqueue));
   }
+
+  // Submission and closing both happen on the parsing thread
+  published_.store(orderIndex, std::memory_order_release);
+  published_.notify_all();
 }
 
-void Runtime::startExecution() { taskQueue_->setReady(); }
+void Runtime::closeSubmission() {
+  published_.fetch_or(closedBit, std::memory_order_release);
+  published_.notify_all();
+}
 
-void Runtime::waitAll() {
-  // Wait for all futures to complete
-  std::lock_guard lock(futuresMtx_);  // NOLINT(misc-const-correctness)
-  for (auto &[idx, future] : futures_) {
-    if (future.valid()) {
-      future.wait();
-    }
+void Runtime::startExecution() {
+  if (plan_ != nullptr) {
+    executor_ = std::make_unique<DataflowExecutor>(numThreads_, *plan_);
+    return;
   }
+  taskQueue_->setReady();
 }
 
-auto Runtime::getResultsInOrder() -> std::vector<QueryResult::Ptr> {
-  std::vector<QueryResult::Ptr> results;
-  results.reserve(totalSubmitted_);
+void Runtime::waitAll() {
+  const std::uint64_t count =
+      published_.load(std::memory_order_acquire) & ~closedBit;
+  for (std::uint64_t index = 1; index <= count; ++index) {
+    slots_.at(index).wait();
+  }
+}
 
-  std::lock_guard lock(futuresMtx_);  // NOLINT(misc-const-correctness)
+auto Runtime::resultReady(std::size_t orderIndex) -> bool {
+  return (published_.load(std::memory_order_acquire) & ~closedBit) >=
+             orderIndex &&
+         slots_.at(orderIndex).ready();
+}
 
-  // Extract results from futures in submission order
-  for (std::size_t i = 1; i <= totalSubmitted_; ++i) {
-    auto itr = futures_.find(i);
-    if (itr != futures_.end() && itr->second.valid()) {
-      try {
-        results.push_back(itr->second.get());
-      } catch (const QuitException &) {
-        // Store nullptr to mark QUIT command - don't break the loop
-        // so that all results are collected
-        results.push_back(nullptr);
-      } catch (const std::exception &e) {
-        auto errorResult = std::make_unique<ErrorMsgResult>(
-            "RUNTIME", "", std::string("Exception: ") + e.what());
-        results.push_back(std::move(errorResult));
-      }
+auto Runtime::takeResult(std::size_t orderIndex)
+    -> std::optional<QueryResult::Ptr> {
+  std::uint64_t published = published_.load(std::memory_order_acquire);
+  while ((published & ~closedBit) < orderIndex) {
+    if ((published & closedBit) != 0) {
+      return std::nullopt;
     }
+    published_.wait(published, std::memory_order_acquire);
+    published = published_.load(std::memory_order_acquire);
   }
-
-  return results;
+  ResultSlot &slot = slots_.at(orderIndex);
+  slot.wait();
+  return slot.take();  // null marks QUIT
 }
@@ -5,22 +5,47 @@
 #ifndef SRC_RUNTIME_RUNTIME_H_
 #define SRC_RUNTIME_RUNTIME_H_
 
+#include <atomic>
 #include <cstddef>
-#include <future>
-#include <map>
+#include <cstdint>
 #include <memory>
-#include <mutex>
-#include <vector>
+#include <optional>
 
 #include "../query/Query.h"
 #include "../query/QueryResult.h"
+#include "../scheduler/BatchPlan.h"
+#include "../scheduler/GlobalIndex.h"
+#include "../scheduler/ResultSlots.h"
 #include "../scheduler/TaskQueue.h"
+#include "DataflowExecutor.h"
 #include "LockManager.h"
 #include "Threadpool.h"
 
+// Tunables of the multi-threaded runtime beyond the worker count
+struct RuntimeOptions {
+  std::size_t ioThreads = 0;  // 0 runs LOAD/DUMP on the compute workers
+  // Plan the whole batch as a DAG once every query has been submitted, see
+  // BatchPlan; ioThreads does not apply then
+  bool batchPlan = false;
+  // How the task queue chooses among tables with runnable tasks
+  TableOrder tableOrder = TableOrder::Backlog;
+  // Serve each table from one worker pinned to a CPU, see Threadpool
+  bool affinity = false;
+  // Like affinity, but with workers pinned to NUMA nodes and each table
+  // loaded and served on one node; affinity alone on a single-node machine
+  bool numa = false;
+  // Run every table as an actor: its queued reads run in parallel, its
+  // writes alone, and workers lock no tables
+  bool actors = false;
+  // Workers active at the start, the others parked until WorkerScaler
+  // wakes them; 0 starts all of them
+  std::size_t activeWorkers = 0;
+};
+
 class Runtime {
 public:
-  explicit Runtime(std::size_t numThreads);
+  explicit Runtime(std::size_t numThreads,
+                   const RuntimeOptions &options = RuntimeOptions{});
   ~Runtime();
 
   Runtime(const Runtime &) = delete;
@@ -28,29 +53,43 @@ public:
   Runtime(Runtime &&) = delete;
   auto operator=(Runtime &&) -> Runtime & = delete;
 
-  // Submit a query and get a future for its result
+  // Submit a query; order indices are dense and submitted in order from 1
   void submitQuery(Query::Ptr query, std::size_t orderIndex);
 
-  // Signal that all queries have been submitted, workers can start
+  // Let workers start fetching; queries may still be submitted afterwards,
+  // except with batchPlan
   void startExecution();
 
   // Wait for all submitted queries to complete
   void waitAll();
 
-  // Get all results in submission order
-  auto getResultsInOrder() -> std::vector<QueryResult::Ptr>;
+  // Mark that no more queries will be submitted
+  void closeSubmission();
+
+  // Whether query `orderIndex` has been submitted and has completed
+  auto resultReady(std::size_t orderIndex) -> bool;
+
+  /**
+   * Block until query `orderIndex` has completed and hand over its result
+   * @return nullopt if submission was closed without such a query; a null
+   * result marks QUIT
+   */
+  auto takeResult(std::size_t orderIndex) -> std::optional<QueryResult::Ptr>;
 
 private:
+  ResultSlots slots_;  // result of query i is slot i; outlives the workers
+
   std::unique_ptr<LockManager> lockMgr_;
   std::unique_ptr<TaskQueue> taskQueue_;
-  std::unique_ptr<Threadpool> threadpool_;
-
-  std::mutex futuresMtx_;
+  std::unique_ptr<Threadpool> threadpool_;  // null with batchPlan
 
-  // Store futures for all submitted queries
-  std::map<std::size_t, std::future<std::unique_ptr<QueryResult>>> futures_;
+  std::size_t numThreads_;
+  std::unique_ptr<BatchPlan> plan_;  // only with batchPlan
+  std::unique_ptr<DataflowExecutor> executor_;
 
-  std::size_t totalSubmitted_{0};
+  // Number of submitted queries, with closedBit set by closeSubmission
+  static constexpr std::uint64_t closedBit = std::uint64_t{1} << 63U;
+  std::atomic<std::uint64_t> published_{0};
 };
 
 #endif  // SRC_RUNTIME_RUNTIME_H_
@@ -9,6 +9,7 @@
 #include <exception>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -22,27 +23,47 @@
 #include "../query/QueryHelpers.h"
 #include "../query/QueryResult.h"
 #include "../scheduler/TaskQueue.h"
+#include "CpuAffinity.h"
+#include "IoExecutor.h"
 #include "LockManager.h"
 #include "Threadpool.h"
 
-Threadpool::Threadpool(std::size_t numThreads, LockManager &lm, TaskQueue &tq)
-    : thread_count_(numThreads), lock_manager_(lm), task_queue_(tq) {
+Threadpool::Threadpool(std::size_t numThreads, std::size_t ioThreads,
+                       LockManager &lm, TaskQueue &tq, bool affinity,
+                       NumaTopology numa, bool actors,
+                       std::size_t activeWorkers)
+    : thread_count_(numThreads), affinity_(affinity), actors_(actors),
+      numa_(std::move(numa)), lock_manager_(lm), task_queue_(tq),
+      scaler_(numThreads, activeWorkers) {
+  if (ioThreads > 0) {
+    io_ = std::make_unique<IoExecutor>(
+        ioThreads, [this](ExecutableTask &task) {
+          this->executeTask(task);
+          task.complete();
+        });
+  }
+  pending_.resize(numThreads);
+  for (auto &done : pending_) {
+    done.reserve(MAX_PENDING_COMPLETIONS);
+  }
   threads_.reserve(numThreads);
   for (std::size_t i = 0; i < numThreads; ++i) {
 #ifdef __cpp_lib_jthread
     threads_.emplace_back(
-        [this](const std::stop_token &st) { this->worker_loop(st); });
+        [this, i](const std::stop_token &st) { this->worker_loop(st, i); });
 #else
-    threads_.emplace_back([this] { this->worker_loop(); });
+    threads_.emplace_back([this, i] { this->worker_loop(i); });
 #endif
   }
 }
 
 Threadpool::~Threadpool() {
 #ifdef __cpp_lib_jthread
-  // jthread automatically requests stop and joins in destructor
+  // jthread automatically requests stop and joins in destructor; a stop
+  // request also wakes a parked worker
 #else
   stop_flag_.store(true);
+  wake_parked();
   for (auto &thread : threads_) {
     if (thread.joinable()) {
       thread.join();
@@ -72,63 +93,125 @@ Threadpool::ReadGuard::ReadGuard(LockManager &lkm, TableId index)
 Threadpool::ReadGuard::~ReadGuard() { lm_.unlockS(id_); }
 
 #ifdef __cpp_lib_jthread
-void Threadpool::worker_loop(const std::stop_token &st_) {
+void Threadpool::worker_loop(const std::stop_token &st_, std::size_t index) {
+  pin_worker(index);
   while (!st_.stop_requested()) {
-    work();
+    if (!scaler_.isActive(index)) {
+      task_queue_.complete(pending_[index]);
+      std::unique_lock<std::mutex> lock(park_mutex_);
+      park_cv_.wait(lock, st_,
+                    [this, index] { return scaler_.isActive(index); });
+      continue;
+    }
+    work(index);
   }
+  task_queue_.complete(pending_[index]);
 }
 #else
-void Threadpool::worker_loop() {
+void Threadpool::worker_loop(std::size_t index) {
+  pin_worker(index);
   while (!stop_flag_.load(std::memory_order_acquire)) {
-    work();
+    if (!scaler_.isActive(index)) {
+      task_queue_.complete(pending_[index]);
+      std::unique_lock<std::mutex> lock(park_mutex_);
+      park_cv_.wait(lock, [this, index] {
+        return scaler_.isActive(index) ||
+               stop_flag_.load(std::memory_order_acquire);
+      });
+      continue;
+    }
+    work(index);
   }
+  task_queue_.complete(pending_[index]);
 }
 #endif
 
-void Threadpool::work() {
-  ExecutableTask task;
-  bool has_task = false;
+void Threadpool::pin_worker(std::size_t index) const {
+  if (numa_.nodeCount() > 1) {
+    // The whole node, so that the parse threads of a LOAD spread over it
+    pinCurrentThreadTo(numa_.nodes[numa_.nodeOfWorker(index)]);
+  } else if (affinity_) {
+    pinCurrentThread(index);
+  }
+}
+
+void Threadpool::wake_parked() {
   {
-    std::unique_lock<std::mutex> lock(local_mutex_);
-    if (local_queue_.empty()) {
-      lock.unlock();
-
-      std::vector<ExecutableTask> batch;
-      batch.reserve(FETCH_BATCH_SIZE);
-
-      for (size_t i = 0; i < FETCH_BATCH_SIZE; ++i) {
-        ExecutableTask tmp;
-        if (!task_queue_.fetchNext(tmp)) {
-          break;
-        }
-        batch.push_back(std::move(tmp));
-      }
+    // A worker between its check and its wait holds the mutex
+    const std::lock_guard<std::mutex> lock(park_mutex_);
+  }
+  park_cv_.notify_all();
+}
 
-      if (!batch.empty()) {
-        lock.lock();
-        for (auto &tmp : batch) {
-          local_queue_.emplace(std::move(tmp));
-        }
-        // Keep lock held to check and extract task
-      } else {
-        // Reacquire lock to safely check queue
-        lock.lock();
-      }
-    } else {
-      // lock is already held from line 70
+auto Threadpool::fetch_shared(ExecutableTask &task, std::size_t index)
+    -> bool {
+  {
+    const std::lock_guard<std::mutex> lock(local_mutex_);
+    if (local_next_ < local_queue_.size()) {
+      task = std::move(local_queue_[local_next_++]);
+      return true;
     }
+  }
+
+  // Task slots of this worker, reused from batch to batch
+  thread_local std::vector<ExecutableTask> batch(FETCH_BATCH_SIZE);
+  std::size_t count = 0;
+  while (count < batch.size() &&
+         task_queue_.fetchNext(batch[count], 0, &pending_[index])) {
+    ++count;
+  }
+  if (scaler_.record(count > 0, task_queue_.readyDepth(),
+                     task_queue_.contention())) {
+    wake_parked();
+  }
+  if (count == 0) {
+    return false;
+  }
 
-    // At this point, lock is always held
-    if (!local_queue_.empty()) {
-      task = std::move(local_queue_.front());
-      local_queue_.pop();
-      has_task = true;
+  task = std::move(batch.front());
+  if (count > 1) {
+    const std::lock_guard<std::mutex> lock(local_mutex_);
+    // Drop the slots already taken; erasing moves, the capacity stays
+    local_queue_.erase(local_queue_.begin(),
+                       local_queue_.begin() +
+                           static_cast<std::ptrdiff_t>(local_next_));
+    local_next_ = 0;
+    for (std::size_t i = 1; i < count; ++i) {
+      local_queue_.push_back(std::move(batch[i]));
     }
-    // lock released when going out of scope
+  }
+  return true;
+}
+
+void Threadpool::work(std::size_t index) {
+  ExecutableTask task;
+  bool has_task = false;
+  if (affinity_) {
+    // Run the task right away so that no other worker picks it up
+    has_task = task_queue_.fetchNext(task, index, &pending_[index]);
+    if (scaler_.record(has_task, task_queue_.readyDepth(),
+                       task_queue_.contention())) {
+      wake_parked();
+    }
+  } else {
+    has_task = fetch_shared(task, index);
   }
 
   if (has_task) {
-    executeTask(task);
+    if (io_ != nullptr && IoExecutor::handles(task)) {
+      io_->post(std::move(task));
+    } else {
+      executeTask(task);
+      // Handed back with the next fetch, under the same lock, unless
+      // tasks of other workers wait for it
+      auto &done = pending_[index];
+      const bool blocking = task.completion.blocking;
+      done.push_back(std::move(task.completion));
+      task.completion.owner = nullptr;
+      if (blocking || done.size() >= MAX_PENDING_COMPLETIONS) {
+        task_queue_.complete(done);
+      }
+    }
   } else {
     // Use shorter sleep when idle to reduce latency
     constexpr int idle_sleep_microseconds = 100;
@@ -138,65 +221,57 @@ void Threadpool::work() {
 }
 
 void Threadpool::executeTask(ExecutableTask &task) {
-  // If query is nullptr (e.g., execOverride-only tasks), execute without lock
+  // If query is nullptr, execute without lock
   if (!task.query) {
     executeNull(task);
     return;
   }
 
-  const TableId tid = resolveTableId(*task.query);
   const QueryKind kind = getQueryKind(task.type);
 
   try {
+    // As actors, tables are handed to one write or to reads at a time by
+    // the TaskQueue, so no table is locked
     if (kind == QueryKind::Write) {
-      const WriteGuard guard(lock_manager_, tid);
+      std::optional<WriteGuard> guard;
+      if (!actors_) {
+        guard.emplace(lock_manager_, resolveTableId(*task.query));
+      }
       executeWrite(task);
+      // Record what LIST shows of the table, for the LISTs queued after it.
+      // The table LOAD and COPYTABLE create is not locked, but its tasks wait
+      // for their completion
+      if (CatalogLog::tracks(task.type)) {
+        task.completion.catalog =
+            CatalogLog::snapshot(task.completion.catalogTable());
+      }
     } else if (kind == QueryKind::Read) {
-      const ReadGuard guard(lock_manager_, tid);
+      std::optional<ReadGuard> guard;
+      if (!actors_) {
+        guard.emplace(lock_manager_, resolveTableId(*task.query));
+      }
       executeRead(task);
     } else {
       executeNull(task);
     }
   } catch (...) {  // NOLINT(bugprone-empty-catch)
     // Intentionally catch and ignore all exceptions to prevent thread
-    // termination Errors are reported via promise/future mechanism in run_logic
+    // termination. Errors are reported through the result slot in run_logic
   }
 }
 
 namespace {
 void run_logic(ExecutableTask &task,  // NOLINT(runtime/references)
                const char * /*type*/) {
-  try {
-    std::unique_ptr<QueryResult> res;
-    if (task.execOverride) {
-      // Use custom execution function if provided
-      res = task.execOverride();
-    } else if (task.query) {
+  task.result->publishFrom([&task]() -> std::unique_ptr<QueryResult> {
+    if (task.query) {
       // Execute the actual query
-      res = task.query->execute();
-    } else {
-      // No query to execute, create a null result
-      res = std::make_unique<NullQueryResult>();
+      return task.query->execute();
     }
-    task.promise.set_value(std::move(res));
-  } catch (...) {
-    try {
-      task.promise.set_exception(std::current_exception());
-    } catch (...) {  // NOLINT(bugprone-empty-catch)
-      // Promise already satisfied, ignore - this is an expected race condition
-    }
-  }
+    // No query to execute, create a null result
+    return std::make_unique<NullQueryResult>();
+  });
 
-  // Always call onCompleted callback if present, even if execution failed
-  // Protect against exceptions in callback
-  if (task.onCompleted) {
-    try {
-      task.onCompleted();
-    } catch (...) {  // NOLINT(bugprone-empty-catch)
-      // Callback should not throw, but protect against it anyway
-      // Intentionally ignore to prevent task failure propagation
-    }
-  }
 }
 }  // namespace
 
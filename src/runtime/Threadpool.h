@@ -1,15 +1,17 @@
 //
 // Threadpool
 // When the threadpool has empty slot, it asks scheduler for tasks. This class
-// focues on thread management and synchronization.
+// focues on thread management and synchronization. Workers beyond what the
+// WorkerScaler deems useful are parked until it wants them again.
 //
 
 #ifndef SRC_RUNTIME_THREADPOOL_H_
 #define SRC_RUNTIME_THREADPOOL_H_
 
+#include <condition_variable>
 #include <cstddef>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 
@@ -18,15 +20,30 @@
 #endif
 
 #include "../scheduler/TaskQueue.h"
+#include "IoExecutor.h"
 #include "LockManager.h"
+#include "NumaTopology.h"
+#include "WorkerScaler.h"
 
 class Threadpool {
 public:
   static constexpr size_t FETCH_BATCH_SIZE = 16;  // Fetch 16 tasks each time
-
-  Threadpool(std::size_t numThreads,
+  // Completions a worker holds before handing them back without a fetch
+  static constexpr size_t MAX_PENDING_COMPLETIONS = FETCH_BATCH_SIZE;
+
+  // ioThreads > 0 routes LOAD/DUMP to a separate IoExecutor of that size.
+  // With affinity each worker is pinned to a CPU and fetches the tables that
+  // `tq` assigns to it, so `tq` has to be created with numThreads workers.
+  // With more than one node in `numa` each worker is pinned to the CPUs of
+  // its node instead, and `tq` has to be created with that many nodes.
+  // With actors tasks run without locking their table: `tq` hands each
+  // table to one write or to its reads at a time. Only `activeWorkers`
+  // workers start active if it is not 0, see WorkerScaler
+  Threadpool(std::size_t numThreads, std::size_t ioThreads,
              LockManager &lm,  // NOLINT(runtime/references)
-             TaskQueue &tq);   // NOLINT(runtime/references)
+             TaskQueue &tq,    // NOLINT(runtime/references)
+             bool affinity = false, NumaTopology numa = {},
+             bool actors = false, std::size_t activeWorkers = 0);
 
   ~Threadpool();
 
@@ -39,11 +56,26 @@ public:
 
 private:
   std::size_t thread_count_;
+  bool affinity_;
+  bool actors_;
+  NumaTopology numa_;
   LockManager &lock_manager_;
   TaskQueue &task_queue_;
 
-  std::queue<ExecutableTask> local_queue_;
-  std::mutex local_mutex_;  // protect local_queue_
+  // Fetched tasks not yet taken start at local_next_; the vector is reused
+  std::vector<ExecutableTask> local_queue_;
+  std::size_t local_next_ = 0;
+  std::mutex local_mutex_;  // protect local_queue_ and local_next_
+
+  // Completions of each worker's executed tasks, handed back to the
+  // TaskQueue with its next fetch, before it parks and when it stops
+  std::vector<CompletionBatch> pending_;
+
+  // Declared before threads_ so that workers are joined before they go away
+  std::unique_ptr<IoExecutor> io_;
+  WorkerScaler scaler_;
+  std::mutex park_mutex_;
+  std::condition_variable_any park_cv_;  // parked workers wait here
 
 #ifdef __cpp_lib_jthread
   std::vector<std::jthread> threads_;
@@ -87,12 +119,23 @@ private:
   };
 
 #ifdef __cpp_lib_jthread
-  void worker_loop(const std::stop_token &st);
+  void worker_loop(const std::stop_token &st, std::size_t index);
 #else
-  void worker_loop();
+  void worker_loop(std::size_t index);
 #endif
 
-  void work();
+  // Pin worker `index` to its CPU or NUMA node, if configured
+  void pin_worker(std::size_t index) const;
+
+  void work(std::size_t index);
+
+  // Take a task from local_queue_; when it is empty, fetch a batch from the
+  // TaskQueue, run the first task and leave the rest in local_queue_
+  auto fetch_shared(ExecutableTask &task,  // NOLINT(runtime/references)
+                    std::size_t index) -> bool;
+
+  // Let parked workers check whether they are active again
+  void wake_parked();
 
   void executeTask(ExecutableTask &task);  // NOLINT(runtime/references)
 
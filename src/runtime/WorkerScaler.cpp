@@ -0,0 +1,51 @@
+//
+// WorkerScaler implementation
+//
+
+#include "WorkerScaler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+auto WorkerScaler::record(bool fetched, std::size_t readyDepth,
+                          std::uint64_t contention) -> bool {
+  if (!fetched) {
+    idle_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Exactly one attempt completes each window and adjusts
+  const std::uint64_t attempt =
+      attempts_.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (attempt % kWindow != 0) {
+    return false;
+  }
+  return adjust(readyDepth, contention);
+}
+
+auto WorkerScaler::adjust(std::size_t readyDepth, std::uint64_t contention)
+    -> bool {
+  const std::lock_guard<std::mutex> lock(adjustMutex_);
+  const auto window = static_cast<double>(kWindow);
+  // The other adjust may have read a later count
+  const double contended =
+      static_cast<double>(contention - std::min(contention, lastContention_)) /
+      window;
+  lastContention_ = std::max(lastContention_, contention);
+  const double idle =
+      static_cast<double>(idle_.exchange(0, std::memory_order_relaxed)) /
+      window;
+
+  const std::size_t active = active_.load(std::memory_order_relaxed);
+  if ((contended > kBackoffContention || idle > kParkIdle) && active > 1) {
+    active_.store(active - 1, std::memory_order_release);
+    return false;
+  }
+  if (readyDepth > active && active < maxWorkers_) {
+    active_.store(std::min(readyDepth, maxWorkers_),
+                  std::memory_order_release);
+    return true;
+  }
+  return false;
+}
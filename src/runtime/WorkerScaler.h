@@ -0,0 +1,66 @@
+//
+// WorkerScaler
+// Decides how many Threadpool workers are active. Workers report every fetch
+// attempt; every kWindow attempts the scaler looks at the window: when the
+// TaskQueue lock was contended on a large share of the attempts, or most
+// attempts found nothing to run, one worker is parked; when more tables are
+// ready than workers are active, enough workers are woken to serve them.
+// Worker 0 is always active.
+//
+
+#ifndef SRC_RUNTIME_WORKERSCALER_H_
+#define SRC_RUNTIME_WORKERSCALER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+class WorkerScaler {
+public:
+  static constexpr std::uint64_t kWindow = 256;
+  // Share of attempts in a window above which a worker is parked
+  static constexpr double kBackoffContention = 0.5;
+  static constexpr double kParkIdle = 0.75;
+
+  // `active` of the `maxWorkers` workers start active, all of them if 0
+  explicit WorkerScaler(std::size_t maxWorkers, std::size_t active = 0)
+      : maxWorkers_(maxWorkers),
+        active_(active == 0 ? maxWorkers : std::min(active, maxWorkers)) {}
+
+  /**
+   * Record one fetch attempt of an active worker
+   * @param fetched whether it got a task
+   * @param readyDepth TaskQueue::readyDepth after the attempt
+   * @param contention TaskQueue::contention after the attempt
+   * @return whether workers have to be woken
+   */
+  auto record(bool fetched, std::size_t readyDepth,
+              std::uint64_t contention) -> bool;
+
+  [[nodiscard]] auto isActive(std::size_t worker) const -> bool {
+    return worker < active_.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] auto active() const -> std::size_t {
+    return active_.load(std::memory_order_relaxed);
+  }
+
+private:
+  // Pick the new active count from the finished window. The attempts that
+  // finish two windows can adjust at the same time, so adjust holds
+  // adjustMutex_
+  auto adjust(std::size_t readyDepth, std::uint64_t contention) -> bool;
+
+  std::size_t maxWorkers_;
+  std::atomic<std::size_t> active_;  // written by adjust only
+
+  std::atomic<std::uint64_t> attempts_{0};
+  std::atomic<std::uint64_t> idle_{0};  // attempts without a task
+
+  std::mutex adjustMutex_;
+  std::uint64_t lastContention_{0};  // guarded by adjustMutex_
+};
+
+#endif  // SRC_RUNTIME_WORKERSCALER_H_
@@ -0,0 +1,138 @@
+//
+// BatchPlan implementation
+//
+
+#include "BatchPlan.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../query/Query.h"
+#include "../query/QueryHelpers.h"
+#include "../query/QueryResult.h"
+#include "../utils/FallbackAnalyzer.h"
+#include "ResultSlots.h"
+
+void BatchPlan::add(Query::Ptr query, ResultSlot &result) {
+  if (quit_) {
+    // Nothing after QUIT runs; the output stops at QUIT anyway
+    result.publish(std::make_unique<NullQueryResult>());
+    return;
+  }
+  const auto index = static_cast<NodeId>(nodes_.size());
+  const QueryType type = query->type();
+  const std::string &table = query->table();
+  std::vector<NodeId> deps;
+  switch (type) {
+  case QueryType::Quit:
+    quit_ = true;
+    barrier(index, deps);
+    break;
+  case QueryType::List:
+    barrier(index, deps);
+    break;
+  case QueryType::Load:
+    if (table.empty()) {
+      barrier(index, deps);  // the file could hold any table
+      break;
+    }
+    write(tables_[table], index, deps);
+    read(files_[query->filePath()], index, deps);
+    break;
+  case QueryType::Dump:
+    read(tables_[table], index, deps);
+    write(files_[query->filePath()], index, deps);
+    break;
+  case QueryType::CopyTable:
+    read(tables_[table], index, deps);
+    write(tables_[query->newTable()], index, deps);
+    break;
+  default:
+    switch (getQueryKind(type)) {
+    case QueryKind::Read:
+      read(tables_[table], index, deps);
+      break;
+    case QueryKind::Write:
+      write(tables_[table], index, deps);
+      break;
+    case QueryKind::Null:
+      break;
+    }
+    break;
+  }
+  if (lastBarrier_ != index) {
+    if (lastBarrier_.has_value()) {
+      deps.push_back(*lastBarrier_);
+    }
+    sinceBarrier_.push_back(index);
+  }
+
+  std::ranges::sort(deps);
+  const auto duplicates = std::ranges::unique(deps);
+  deps.erase(duplicates.begin(), duplicates.end());
+  for (const NodeId dep : deps) {
+    nodes_[dep].successors.push_back(index);
+  }
+  Node node;
+  node.query = std::move(query);
+  node.result = &result;
+  node.predecessors = static_cast<std::uint32_t>(deps.size());
+  nodes_.push_back(std::move(node));
+}
+
+void BatchPlan::read(Resource &resource, NodeId index,
+                     std::vector<NodeId> &deps) {
+  if (resource.writer.has_value() && !implied(*resource.writer)) {
+    deps.push_back(*resource.writer);
+  }
+  resource.readers.push_back(index);
+}
+
+void BatchPlan::write(Resource &resource, NodeId index,
+                      std::vector<NodeId> &deps) {
+  if (resource.readers.empty()) {
+    // Readers already follow the last write, so only a bare write is a dep
+    if (resource.writer.has_value() && !implied(*resource.writer)) {
+      deps.push_back(*resource.writer);
+    }
+  }
+  for (const NodeId reader : resource.readers) {
+    if (!implied(reader)) {
+      deps.push_back(reader);
+    }
+  }
+  resource.writer = index;
+  resource.readers.clear();
+}
+
+void BatchPlan::barrier(NodeId index, std::vector<NodeId> &deps) {
+  // Nodes since the last barrier follow that barrier, so they cover it
+  // unless there are none
+  deps = std::move(sinceBarrier_);
+  if (deps.empty() && lastBarrier_.has_value()) {
+    deps.push_back(*lastBarrier_);
+  }
+  sinceBarrier_.clear();
+  lastBarrier_ = index;
+}
+
+auto BatchPlan::finalize() -> std::vector<NodeId> {
+  std::vector<NodeId> roots;
+  // Edges only point to later nodes, so one backward pass ranks them all
+  for (auto index = static_cast<NodeId>(nodes_.size()); index-- > 0;) {
+    Node &node = nodes_[index];
+    std::uint64_t longest = 0;
+    for (const NodeId next : node.successors) {
+      longest = std::max(longest, nodes_[next].rank);
+    }
+    node.rank = longest + estimateQueryComplexity(*node.query) + 1;
+    if (node.predecessors == 0) {
+      roots.push_back(index);
+    }
+  }
+  return roots;
+}
@@ -0,0 +1,74 @@
+//
+// BatchPlan - whole-batch dependency DAG for planned execution
+// When every query is known before execution starts, the dependencies that
+// TaskQueue discovers one completion at a time can be computed up front. Each
+// query becomes a node with edges from the earlier queries it conflicts with:
+// a write of a table or file follows every earlier access to it, a read
+// follows only the last write, so reads between two writes run in parallel.
+// LIST and QUIT are barriers, and so is a LOAD whose table is not known.
+// Queries after QUIT are never run. Nodes are ranked by the estimated cost of
+// the longest path from them to the end of the batch (the critical path).
+//
+
+#ifndef SRC_SCHEDULER_BATCHPLAN_H_
+#define SRC_SCHEDULER_BATCHPLAN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../query/Query.h"
+#include "ResultSlots.h"
+
+class BatchPlan {
+public:
+  using NodeId = std::uint32_t;
+
+  struct Node {
+    Query::Ptr query;
+    ResultSlot *result = nullptr;
+    std::vector<NodeId> successors;
+    std::uint32_t predecessors = 0;
+    std::uint64_t rank = 0;  // cost of the longest path starting here
+  };
+
+  // Add the next query of the batch, in sequence order
+  void add(Query::Ptr query, ResultSlot &result);
+
+  // Rank every node; returns the nodes without predecessors
+  auto finalize() -> std::vector<NodeId>;
+
+  auto node(NodeId index) -> Node & { return nodes_[index]; }
+  [[nodiscard]] auto size() const -> std::size_t { return nodes_.size(); }
+
+private:
+  // Accesses to one table or file since its last write
+  struct Resource {
+    std::optional<NodeId> writer;
+    std::vector<NodeId> readers;
+  };
+
+  void read(Resource &resource, NodeId index,
+            std::vector<NodeId> &deps);  // NOLINT(runtime/references)
+  void write(Resource &resource, NodeId index,
+             std::vector<NodeId> &deps);  // NOLINT(runtime/references)
+  void barrier(NodeId index,
+               std::vector<NodeId> &deps);  // NOLINT(runtime/references)
+
+  // Whether a dependency on `dep` already follows from the last barrier
+  [[nodiscard]] auto implied(NodeId dep) const -> bool {
+    return lastBarrier_.has_value() && dep < *lastBarrier_;
+  }
+
+  std::vector<Node> nodes_;
+  std::unordered_map<std::string, Resource> tables_;
+  std::unordered_map<std::string, Resource> files_;
+  std::optional<NodeId> lastBarrier_;
+  std::vector<NodeId> sinceBarrier_;  // nodes added after the last barrier
+  bool quit_ = false;
+};
+
+#endif  // SRC_SCHEDULER_BATCHPLAN_H_
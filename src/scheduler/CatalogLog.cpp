@@ -0,0 +1,118 @@
+//
+// CatalogLog implementation
+//
+
+#include "CatalogLog.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../db/Database.h"
+#include "../db/Table.h"
+
+auto CatalogLog::tracks(QueryType type) -> bool {
+  switch (type) {
+  case QueryType::Load:
+  case QueryType::Drop:
+  case QueryType::Truncate:
+  case QueryType::CopyTable:
+  case QueryType::Insert:
+  case QueryType::Delete:
+  case QueryType::Duplicate:
+    return true;
+  default:
+    return false;
+  }
+}
+
+auto CatalogLog::snapshot(const std::string &table) -> TableStats {
+  TableStats stats;
+  if (const Table *found = Database::getInstance().find(table)) {
+    stats.exists = true;
+    stats.fields = found->field().size() + 1;
+    stats.rows = found->size();
+  }
+  return stats;
+}
+
+void CatalogLog::expect(std::uint64_t seq) { lists_.insert(seq); }
+
+void CatalogLog::record(std::uint64_t seq, QueryType type,
+                        const std::string &table, const TableStats &stats) {
+  const bool creates =
+      type == QueryType::Load || type == QueryType::CopyTable;
+  // A failed LOAD or COPYTABLE leaves an existing table listed where it was
+  if ((creates && stats.exists) || type == QueryType::Drop) {
+    events_.emplace(seq, std::make_pair(table, creates));
+  }
+  auto &versions = versions_[table];
+  const auto later = std::find_if(
+      versions.begin(), versions.end(),
+      [seq](const Version &version) { return version.seq > seq; });
+  versions.insert(later, {seq, stats});
+  prune(versions);
+}
+
+auto CatalogLog::list(std::uint64_t seq) -> std::string {
+  for (auto event = events_.begin();
+       event != events_.end() && event->first < seq;
+       event = events_.erase(event)) {
+    if (event->second.second) {
+      order_.emplace(event->second.first, true);
+    } else {
+      order_.erase(event->second.first);
+    }
+  }
+
+  const int width = 15;
+  std::ostringstream out;
+  out << "Database overview:" << '\n';
+  out << "=========================" << '\n';
+  out << std::setw(width) << "Table name";
+  out << std::setw(width) << "# of fields";
+  out << std::setw(width) << "# of entries" << '\n';
+  for (const auto &entry : order_) {
+    const auto &versions = versions_[entry.first];
+    // The last version before the LIST; a created table has one
+    std::size_t index = versions.size();
+    while (index > 0 && versions[index - 1].seq > seq) {
+      --index;
+    }
+    const TableStats stats =
+        index > 0 ? versions[index - 1].stats : TableStats{};
+    out << std::setw(width) << entry.first;
+    out << std::setw(width) << stats.fields;
+    out << std::setw(width) << stats.rows << '\n';
+  }
+  out << "Total " << order_.size() << " tables." << '\n';
+  out << "=========================" << '\n';
+
+  lists_.erase(seq);
+  for (auto &entry : versions_) {
+    prune(entry.second);
+  }
+  return std::move(out).str();
+}
+
+auto CatalogLog::listBetween(std::uint64_t after,
+                             std::uint64_t before) const -> bool {
+  const auto next = lists_.upper_bound(after);
+  return next != lists_.end() && *next < before;
+}
+
+void CatalogLog::prune(std::vector<Version> &versions) const {
+  std::size_t kept = 0;
+  for (std::size_t index = 0; index < versions.size(); ++index) {
+    const bool last = index + 1 == versions.size();
+    if (last || listBetween(versions[index].seq, versions[index + 1].seq)) {
+      versions[kept++] = versions[index];
+    }
+  }
+  versions.resize(kept);
+}
@@ -0,0 +1,70 @@
+#ifndef SRC_SCHEDULER_CATALOGLOG_H_
+#define SRC_SCHEDULER_CATALOGLOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../query/Query.h"
+
+// What LIST shows of a table
+struct TableStats {
+  bool exists = false;
+  std::size_t fields = 0;  // including KEY
+  std::size_t rows = 0;
+};
+
+// CatalogLog answers LIST without draining the workers.
+// Every task that can create, drop or resize a table records the table's
+// stats after it ran, tagged with its seq. Records of different tables
+// arrive in any order. A LIST at seq S is rendered once every task before S
+// has been recorded, from the last version of each table before S, even if
+// later tasks have already run. Only the versions that pending LISTs still
+// need are kept. Tables are listed in the order Database::tables iterates
+// them in a single-threaded run: the creations (LOAD, COPYTABLE) and drops
+// are replayed in seq order on a map of the same type.
+class CatalogLog {
+public:
+  // A LIST at `seq` is pending; register it before any later task records
+  void expect(std::uint64_t seq);
+
+  // Stats of `table` after the task `seq` of type `type`
+  void record(std::uint64_t seq, QueryType type, const std::string &table,
+              const TableStats &stats);
+
+  // Whether a query can create, drop or resize its table
+  static auto tracks(QueryType type) -> bool;
+
+  // Current stats of `table`; the table has to be locked
+  static auto snapshot(const std::string &table) -> TableStats;
+
+  // Render the pending LIST at `seq` like Database::printAllTable; every
+  // task before it has to be recorded
+  auto list(std::uint64_t seq) -> std::string;
+
+private:
+  struct Version {
+    std::uint64_t seq = 0;
+    TableStats stats;
+  };
+
+  // Whether a pending LIST lies strictly between two seqs
+  [[nodiscard]] auto listBetween(std::uint64_t after,
+                                 std::uint64_t before) const -> bool;
+  // Drop the versions no pending LIST needs, keeping the latest
+  void prune(
+      std::vector<Version> &versions) const;  // NOLINT(runtime/references)
+
+  std::set<std::uint64_t> lists_;  // pending LISTs
+  std::unordered_map<std::string, std::vector<Version>> versions_;
+  // Creations (true) and drops (false) not replayed on order_ yet
+  std::map<std::uint64_t, std::pair<std::string, bool>> events_;
+  std::unordered_map<std::string, bool> order_;
+};
+
+#endif  // SRC_SCHEDULER_CATALOGLOG_H_
@@ -1,11 +1,13 @@
 #include "DependencyManager.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "../query/Query.h"
@@ -15,45 +17,19 @@
 void DependencyManager::markScheduled(ScheduledItem &item, QueryType tag) {
   auto seq = item.seq;
   const std::string &tableId = item.tableId;
+  // A LOAD or COPYTABLE waits for every earlier task on the table it
+  // (re)creates: one still queued would run on the new table
+  const auto prevTask = markTableTask(tableId, seq);
 
   if (item.type == QueryType::Load) {
-    std::vector<std::string> pendingTables;
     auto filePath = extractFilePath(*item.query);
     auto prevFile = markScheduledFile(filePath, seq, tag);
-    auto prevFileTag = prevFile.first;
     auto prevFileSeq = prevFile.second;
 
-    auto completedIter = lastCompletedFile.find(filePath);
-    std::uint64_t const fileCompleted =
-        completedIter == lastCompletedFile.end() ? 0 : completedIter->second;
-
-    // Only drop if there was a PREVIOUS Load (prevFileSeq > 0) and table not
-    // dropped
-    item.droppedFlag = (prevFileSeq > 0 && prevFileTag == QueryType::Load &&
-                        lastScheduledTable[tableId].first != QueryType::Drop);
-
-    bool const pending =
-        (prevFileTag == QueryType::Dump && fileCompleted < prevFileSeq);
-
-    if (pending) {
-      // Pending LOAD
-      // Apply Nop to any tables currently marked Drop to enforce one-hop wait
-      for (auto &entry : lastScheduledTable) {
-        if (entry.second.first == QueryType::Drop) {
-          entry.second.first = QueryType::Nop;
-          entry.second.second = seq;
-          pendingTables.emplace_back(entry.first);
-        }
-      }
-      // Record only file dependency, tableDependsOn left 0 (to be resolved
-      // after file complete)
-      item.depends = LoadDeps(prevFileSeq, 0, filePath, pendingTables);
-      return;
-    }
-
-    auto prevTable = markScheduledTable(tableId, seq, tag);
-    auto prevTableSeq = prevTable.second;
-    item.depends = LoadDeps(prevFileSeq, prevTableSeq, filePath, pendingTables);
+    // The parser names the table of a file after the last DUMP to it, so
+    // a LOAD of a file still being dumped is ordered on its table as well
+    markScheduledTable(tableId, seq, tag);
+    item.depends = LoadDeps(prevFileSeq, prevTask, filePath);
     return;
   }
 
@@ -80,12 +56,27 @@ void DependencyManager::markScheduled(ScheduledItem &item, QueryType tag) {
     auto res = markScheduledTable(tableId, seq, tag);
     auto srcTableDependsOn = res.second;
     auto newTableId = extractNewTable(*item.query);
-    res = markScheduledTable(newTableId, seq, tag);
-    auto dstTableDependsOn = res.second;
+    markScheduledTable(newTableId, seq, tag);
+    auto dstTableDependsOn = markTableTask(newTableId, seq);
     item.depends =
         CopyTableDeps(srcTableDependsOn, dstTableDependsOn, newTableId);
     return;
   }
+
+  // Not queued behind the LOAD or COPYTABLE that (re)creates its table, it
+  // would be handed out as soon as an earlier DROP completed
+  auto tableIter = lastScheduledTable.find(tableId);
+  if (tableIter != lastScheduledTable.end() && tableIter->second.second > 0) {
+    item.depends = TableDeps(tableIter->second.second);
+  }
+}
+
+auto DependencyManager::markTableTask(const std::string &tableId,
+                                      std::uint64_t seq) -> std::uint64_t {
+  auto &last = lastTaskTable[tableId];
+  const auto ret = last;
+  last = std::max(last, seq);
+  return ret;
 }
 
 auto DependencyManager::markScheduledFile(const std::string &filePath,
@@ -186,6 +177,11 @@ auto DependencyManager::notifyCompleteBreakHelper(
               std::get<DropDeps>(waitItem.depends).tableDependsOn >
                   completedSeq)) {
     return true;  // dependency not satisfied
+  } else if (type == DependencyType::Table &&
+             std::holds_alternative<TableDeps>(waitItem.depends) &&
+             std::get<TableDeps>(waitItem.depends).tableDependsOn >
+                 completedSeq) {
+    return true;  // dependency not satisfied
   } else if (waitItem.type == QueryType::CopyTable &&
              type == DependencyType::Table) {
     const auto &copyDeps = std::get<CopyTableDeps>(waitItem.depends);
@@ -206,3 +202,12 @@ auto DependencyManager::lastCompletedFor(
   auto iter = lastCompletedMap.find(key);
   return iter == lastCompletedMap.end() ? 0 : iter->second;
 }
+
+auto DependencyManager::waitingOn(const DependencyType &type,
+                                  const std::string &key) const
+    -> std::size_t {
+  const auto &waitingMap =
+      type == DependencyType::File ? waitingFile : waitingTable;
+  auto iter = waitingMap.find(key);
+  return iter == waitingMap.end() ? 0 : iter->second.size();
+}
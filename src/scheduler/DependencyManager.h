@@ -1,6 +1,7 @@
 #ifndef SRC_SCHEDULER_DEPENDENCYMANAGER_H_
 #define SRC_SCHEDULER_DEPENDENCYMANAGER_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <queue>
@@ -53,6 +54,10 @@ public:
   lastCompletedFor(const DependencyType &type,
                    const std::string &key) const -> std::uint64_t;
 
+  // Number of tasks held back until `key` completes a task
+  [[nodiscard]] auto waitingOn(const DependencyType &type,
+                               const std::string &key) const -> std::size_t;
+
 private:
   std::unordered_map<std::string, std::pair<QueryType, std::uint64_t>>
       lastScheduledFile;
@@ -60,6 +65,8 @@ private:
   std::unordered_map<std::string, std::pair<QueryType, std::uint64_t>>
       lastScheduledTable;
   std::unordered_map<std::string, std::uint64_t> lastCompletedTable;
+  // Last task of any type on each table
+  std::unordered_map<std::string, std::uint64_t> lastTaskTable;
 
   std::unordered_map<std::string, WaitingHeap> waitingFile;
   std::unordered_map<std::string, WaitingHeap> waitingTable;
@@ -70,6 +77,10 @@ private:
   auto markScheduledTable(const std::string &tableId, std::uint64_t seq,
                           QueryType tag) -> std::pair<QueryType, std::uint64_t>;
 
+  // Record `seq` as the last task on `tableId`, returning the one before
+  auto markTableTask(const std::string &tableId,
+                     std::uint64_t seq) -> std::uint64_t;
+
   auto static notifyCompleteBreakHelper(const DependencyType &type,
                                         const uint64_t &completedSeq,
                                         const ScheduledItem &waitItem) -> bool;
@@ -1,38 +1,103 @@
 #include "GlobalIndex.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <optional>
+#include <string_view>
 
 #include "../query/QueryPriority.h"
 #include "TableQueue.h"
 
-// Push a new Key with incremented version to invalidate older entries.
+auto GlobalIndex::parseOrder(std::string_view value)
+    -> std::optional<TableOrder> {
+  if (value == "backlog") {
+    return TableOrder::Backlog;
+  }
+  if (value == "fair") {
+    return TableOrder::Fair;
+  }
+  return std::nullopt;
+}
+
 void GlobalIndex::upsert(TableQueue *tableQ, QueryPriority priorityLevel,
-                         std::uint64_t enqueueTick, std::uint64_t headSeq) {
+                         std::uint64_t enqueueTick, std::uint64_t headSeq,
+                         std::uint64_t weight) {
   if (tableQ == nullptr) {
     return;
   }
-  auto &ver = latestVersion[tableQ];
-  ++ver;  // update & record version
-  heap.push(Key{.pri = priorityLevel,
+  const Key key{.pri = priorityLevel,
                 .stamp = enqueueTick,
                 .headSeq = headSeq,
-                .tbl = tableQ,
-                .version = ver});
+                .weight = weight,
+                .tbl = tableQ};
+  std::size_t slot = tableQ->indexSlot;
+  if (slot == kNoSlot) {
+    slot = heap.size();
+    heap.push_back(key);
+  }
+  place(slot, key);
+  siftUp(slot);
+  siftDown(tableQ->indexSlot);
 }
 
-// Discard stale heap entries until a current one surfaces.
 auto GlobalIndex::pickBest(TableQueue *&outTableQ) -> bool {
-  while (!heap.empty()) {
-    const Key &top = heap.top();
-    auto versionIt = latestVersion.find(top.tbl);
-    if (versionIt == latestVersion.end() || versionIt->second != top.version) {
-      heap.pop();
-      continue;
+  if (heap.empty()) {
+    outTableQ = nullptr;
+    return false;
+  }
+  outTableQ = heap.front().tbl;
+  outTableQ->indexSlot = kNoSlot;
+  const Key last = heap.back();
+  heap.pop_back();
+  if (!heap.empty()) {
+    place(0, last);
+    siftDown(0);
+  }
+  return true;
+}
+
+auto GlobalIndex::contains(const TableQueue &tableQ) -> bool {
+  return tableQ.indexSlot != kNoSlot;
+}
+
+void GlobalIndex::place(std::size_t slot, const Key &key) {
+  heap[slot] = key;
+  key.tbl->indexSlot = slot;
+}
+
+void GlobalIndex::siftUp(std::size_t slot) {
+  const Key key = heap[slot];
+  while (slot > 0) {
+    const std::size_t parent = (slot - 1) / kArity;
+    if (!before(key, heap[parent])) {
+      break;
+    }
+    place(slot, heap[parent]);
+    slot = parent;
+  }
+  place(slot, key);
+}
+
+void GlobalIndex::siftDown(std::size_t slot) {
+  const Key key = heap[slot];
+  while (true) {
+    const std::size_t first = (slot * kArity) + 1;
+    if (first >= heap.size()) {
+      break;
+    }
+    const std::size_t last = std::min(first + kArity, heap.size());
+    std::size_t best = first;
+    for (std::size_t child = first + 1; child < last; ++child) {
+      if (before(heap[child], heap[best])) {
+        best = child;
+      }
+    }
+    if (!before(heap[best], key)) {
+      break;
     }
-    outTableQ = top.tbl;
-    heap.pop();
-    return true;
+    place(slot, heap[best]);
+    slot = best;
   }
-  outTableQ = nullptr;
-  return false;
+  place(slot, key);
 }
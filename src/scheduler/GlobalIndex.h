@@ -3,20 +3,33 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <queue>
-#include <unordered_map>
+#include <optional>
+#include <string_view>
 #include <vector>
 
 #include "../query/QueryPriority.h"
 
 struct TableQueue;
 
+// How GlobalIndex orders tables of the same priority
+enum class TableOrder : std::uint8_t {
+  Backlog,  // most remaining work first, see GlobalIndex
+  Fair,     // longest waiting first
+};
+
 // GlobalIndex is a cross-table selection structure.
-// Ordering: higher priority first; then fairness by enqueueTick with a
-// tolerance window kFairnessQuantum; finally fallback to headseq
+// Ordering: higher priority first; then, with TableOrder::Fair, fairness by
+// enqueueTick with a tolerance window kFairnessQuantum. With
+// TableOrder::Backlog the table with the larger weight (remaining work) goes
+// first, so the longest backlog does not end up running alone at the end;
+// tables that waited kAgingLimit ticks longer still win to avoid starvation.
+// Finally fallback to headseq.
+// Tables live in an indexed 4-ary heap: every TableQueue knows its heap slot,
+// so updating a table's key moves it in place instead of leaving stale entries
 class GlobalIndex {
 public:
-  GlobalIndex() = default;
+  explicit GlobalIndex(TableOrder order = TableOrder::Backlog)
+      : order_(order), cmp_{order} {}
   ~GlobalIndex() = default;
   GlobalIndex(const GlobalIndex &) = delete;
   auto operator=(const GlobalIndex &) -> GlobalIndex & = delete;
@@ -25,11 +38,22 @@ public:
 
   // Fairness constants (quantization)
   static constexpr std::uint64_t kFairnessQuantum = 64;  // can be modified
+  static constexpr std::uint64_t kAgingLimit = 16 * kFairnessQuantum;
+  static constexpr std::size_t kArity = 4;
+  static constexpr std::size_t kNoSlot = static_cast<std::size_t>(-1);
+
+  static auto parseOrder(std::string_view value) -> std::optional<TableOrder>;
 
+  // Insert the table, or update its key if it is already indexed
   void upsert(TableQueue *tableQ, QueryPriority priorityLevel,
-              std::uint64_t enqueueTick, std::uint64_t headSeq);
+              std::uint64_t enqueueTick, std::uint64_t headSeq,
+              std::uint64_t weight);
+  // Remove and return the best table
   auto pickBest(TableQueue *&outTableQ) -> bool;  // NOLINT(runtime/references)
 
+  // Whether the table is in a GlobalIndex; it is in at most one
+  [[nodiscard]] static auto contains(const TableQueue &tableQ) -> bool;
+  [[nodiscard]] auto order() const -> TableOrder { return order_; }
   [[nodiscard]] auto empty() const -> bool { return heap.empty(); }
   [[nodiscard]] auto size() const -> std::size_t { return heap.size(); }
 
@@ -38,10 +62,12 @@ private:
     QueryPriority pri{};       // priority level of representative key //NOLINT
     std::uint64_t stamp{0};    // enqueueTick //NOLINT
     std::uint64_t headSeq{0};  // sequence index //NOLINT
+    std::uint64_t weight{0};   // remaining work of the table //NOLINT
     TableQueue *tbl{nullptr};  // table queue //NOLINT
-    std::uint64_t version{0};  // monotonic to invalidate stale entries //NOLINT
   };
   struct KeyCmp {
+    TableOrder order{TableOrder::Backlog};
+
     auto operator()(const Key &leftKey, const Key &rightKey) const -> bool {
       if (leftKey.pri != rightKey.pri) {
         return leftKey.pri > rightKey.pri;  // higher priority first
@@ -49,15 +75,30 @@ private:
       const std::uint64_t diff = (leftKey.stamp > rightKey.stamp)
                                      ? (leftKey.stamp - rightKey.stamp)
                                      : (rightKey.stamp - leftKey.stamp);
-      if (diff >= kFairnessQuantum) {
+      const std::uint64_t window =
+          order == TableOrder::Fair ? kFairnessQuantum : kAgingLimit;
+      if (diff >= window) {
         return leftKey.stamp >
                rightKey.stamp;  // balance work according to time
       }
+      if (order == TableOrder::Backlog && leftKey.weight != rightKey.weight) {
+        return leftKey.weight < rightKey.weight;  // more work first
+      }
       return leftKey.headSeq > rightKey.headSeq;  // smaller headSeq first
     }
   };
-  std::priority_queue<Key, std::vector<Key>, KeyCmp> heap;
-  std::unordered_map<TableQueue *, std::uint64_t> latestVersion;
+  // Whether `lhs` is picked before `rhs`
+  [[nodiscard]] auto before(const Key &lhs, const Key &rhs) const -> bool {
+    return cmp_(rhs, lhs);
+  }
+  // Store `key` at `slot` and tell its table
+  void place(std::size_t slot, const Key &key);
+  void siftUp(std::size_t slot);
+  void siftDown(std::size_t slot);
+
+  TableOrder order_;
+  KeyCmp cmp_;
+  std::vector<Key> heap;
 };
 
 #endif  // SRC_SCHEDULER_GLOBALINDEX_H_
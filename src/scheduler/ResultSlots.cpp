@@ -0,0 +1,39 @@
+//
+// ResultSlots implementation
+//
+
+#include "ResultSlots.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "../query/QueryResult.h"
+
+void ResultSlot::publish(QueryResult::Ptr result) {
+  result_ = std::move(result);
+  state_.store(State::Ready, std::memory_order_release);
+  state_.notify_one();
+}
+
+void ResultSlot::publishQuit() {
+  state_.store(State::Quit, std::memory_order_release);
+  state_.notify_one();
+}
+
+void ResultSlot::wait() const {
+  state_.wait(State::Pending, std::memory_order_acquire);
+}
+
+auto ResultSlots::claim(std::uint64_t seq) -> ResultSlot & {
+  const std::uint64_t segment = seq >> segmentBits;
+  if (segment >= segments_.size()) {
+    throw std::length_error("Too many queries for the result slots");
+  }
+  if (segments_[segment] == nullptr) {
+    segments_[segment] = std::make_unique<Segment>();
+  }
+  return at(seq);
+}
@@ -0,0 +1,91 @@
+//
+// ResultSlots - per-query result storage of the multi-threaded runtime
+// Sequence numbers are dense, so the result of query `seq` lives at a fixed
+// position of a segmented array. A worker writes the result into its slot and
+// publishes it with an atomic state; readers block on that state with
+// std::atomic::wait. Segments are allocated as queries are submitted and are
+// never moved, so a slot stays valid for the lifetime of the runtime.
+//
+
+#ifndef SRC_SCHEDULER_RESULTSLOTS_H_
+#define SRC_SCHEDULER_RESULTSLOTS_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../query/QueryResult.h"
+#include "../utils/uexception.h"
+
+class ResultSlot {
+public:
+  // Store the result of the query and wake a waiting reader
+  void publish(QueryResult::Ptr result);
+
+  // Mark the query as QUIT, which has no result
+  void publishQuit();
+
+  // Publish what `execute` returns. QUIT and exceptions are published as
+  // well, so a reader never waits for a query that has run
+  template <typename Execute> void publishFrom(Execute &&execute) {
+    try {
+      publish(std::forward<Execute>(execute)());
+    } catch (const QuitException &) {
+      publishQuit();
+    } catch (const std::exception &e) {
+      publish(std::make_unique<ErrorMsgResult>(
+          "RUNTIME", "", std::string("Exception: ") + e.what()));
+    } catch (...) {
+      publish(std::make_unique<ErrorMsgResult>("RUNTIME", "",
+                                               "Unknown exception"));
+    }
+  }
+
+  [[nodiscard]] auto ready() const -> bool {
+    return state_.load(std::memory_order_acquire) != State::Pending;
+  }
+
+  // Block until the result is published
+  void wait() const;
+
+  // Hand over the published result; null marks QUIT
+  auto take() -> QueryResult::Ptr { return std::move(result_); }
+
+private:
+  enum class State : std::uint8_t { Pending, Ready, Quit };
+
+  QueryResult::Ptr result_;
+  std::atomic<State> state_{State::Pending};
+};
+
+class ResultSlots {
+public:
+  static constexpr std::size_t segmentBits = 14;
+  static constexpr std::size_t segmentSize = std::size_t{1} << segmentBits;
+  static constexpr std::size_t maxSegments = std::size_t{1} << 14U;
+
+  ResultSlots() : segments_(maxSegments) {}
+
+  // Slot of query `seq`, allocating its segment on first use. Only the
+  // submitting thread may call this
+  auto claim(std::uint64_t seq) -> ResultSlot &;
+
+  // Slot of a query that has already been claimed
+  auto at(std::uint64_t seq) -> ResultSlot & {
+    return (*segments_[seq >> segmentBits])[seq & (segmentSize - 1)];
+  }
+
+private:
+  using Segment = std::array<ResultSlot, segmentSize>;
+
+  // Sized once: readers index it while the submitter adds segments
+  std::vector<std::unique_ptr<Segment>> segments_;
+};
+
+#endif  // SRC_SCHEDULER_RESULTSLOTS_H_
@@ -2,7 +2,6 @@
 #define SRC_SCHEDULER_SCHEDULEDITEM_H_
 
 #include <cstdint>
-#include <future>
 #include <memory>
 #include <string>
 #include <variant>
@@ -10,6 +9,7 @@
 
 #include "../query/Query.h"
 #include "../query/QueryPriority.h"
+#include "ResultSlots.h"
 
 class Query;
 class QueryResult;
@@ -18,7 +18,6 @@ struct LoadDeps {
   std::uint64_t fileDependsOn{0};
   std::uint64_t tableDependsOn{0};
   std::string filePath;
-  std::vector<std::string> pendingTable;
 };
 struct DumpDeps {
   std::uint64_t fileDependsOn{0};
@@ -28,13 +27,18 @@ struct DumpDeps {
 struct DropDeps {
   std::uint64_t tableDependsOn{0};
 };
+// Any other query on a table: the last LOAD, DUMP, DROP or COPYTABLE of the
+// table scheduled before it
+struct TableDeps {
+  std::uint64_t tableDependsOn{0};
+};
 struct CopyTableDeps {
   std::uint64_t srcTableDependsOn{0};
   std::uint64_t dstTableDependsOn{0};
   std::string newTable;
 };
-using DependencyPayload =
-    std::variant<std::monostate, LoadDeps, DumpDeps, DropDeps, CopyTableDeps>;
+using DependencyPayload = std::variant<std::monostate, LoadDeps, DumpDeps,
+                                       DropDeps, TableDeps, CopyTableDeps>;
 
 // One scheduled task (move-only)
 struct ScheduledItem {
@@ -42,11 +46,10 @@ struct ScheduledItem {
   QueryPriority priority = QueryPriority::NORMAL;  // NOLINT
   std::string tableId;              // table name or "__control__" //NOLINT
   QueryType type = QueryType::Nop;  // type of the query //NOLINT
+  std::uint32_t cost = 0;  // estimated work, at least 1 //NOLINT
   DependencyPayload depends;     // default is std::monostate (no deps) //NOLINT
   std::unique_ptr<Query> query;  // NOLINT
-  std::promise<std::unique_ptr<QueryResult>>
-      promise;               // result promise //NOLINT
-  bool droppedFlag = false;  // dropped mark//NOLINT
+  ResultSlot *result = nullptr;  // result destination //NOLINT
 
   ScheduledItem() noexcept = default;
   ~ScheduledItem() = default;
@@ -1,19 +1,70 @@
 #ifndef SRC_SCHEDULER_TABLEQUEUE_H_
 #define SRC_SCHEDULER_TABLEQUEUE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <optional>
+#include <utility>
 
+#include "./GlobalIndex.h"
 #include "./ScheduledItem.h"
 
 struct TableQueue {
   bool registered{false};           // LOAD or not //NOLINT
   std::uint64_t registerSeq{0};     // seq of LOAD //NOLINT
+  // Nothing queued, running or waiting on dependencies: a task registered
+  // while idle has to be put into the GlobalIndex by registerTask itself.
+  // Tasks on a table that is not created yet wait in DependencyManager
+  bool idle{true};                  // NOLINT
+  // Slot in the GlobalIndex heap, maintained by GlobalIndex. While indexed,
+  // the table waits there since indexedTick, with indexedWork queued
+  std::size_t indexSlot{GlobalIndex::kNoSlot};  // NOLINT
+  std::uint64_t indexedTick{0};                 // NOLINT
+  std::uint64_t indexedWork{0};                 // NOLINT
+  std::uint64_t work{0};            // sum of the queued items' cost //NOLINT
+  // Reads handed out and not completed, when reads fan out; the next write
+  // waits until they are done
+  std::size_t reading{0};           // NOLINT
+  // seq of the last read handed out
+  std::uint64_t readSeq{0};         // NOLINT
+  // Queries registered on the table and not completed, other than LOAD,
+  // DUMP, DROP and COPYTABLE, and the seq of the last of them
+  std::size_t tasks{0};             // NOLINT
+  std::uint64_t lastTaskSeq{0};     // NOLINT
+  // A LOAD or COPYTABLE recreating the table waits for those queries, so
+  // DependencyManager has to see them complete; nothing else waits on them
+  bool notifyDeps{false};           // NOLINT
+  // Worker whose GlobalIndex holds the table, with affinity
+  std::optional<std::size_t> worker;  // NOLINT
   std::deque<ScheduledItem> queue;  // NOLINT
 
   [[nodiscard]] auto size() const -> std::size_t { return queue.size(); }
   [[nodiscard]] auto empty() const -> bool { return queue.empty(); }
+
+  void pushBack(ScheduledItem &&item) {
+    work += item.cost;
+    queue.push_back(std::move(item));
+  }
+  // Put back a task released by DependencyManager. Several tasks of a
+  // table can wait there and be released together, so they are merged in
+  // by seq
+  void putBack(ScheduledItem &&item) {
+    work += item.cost;
+    const auto pos = std::upper_bound(
+        queue.begin(), queue.end(), item.seq,
+        [](std::uint64_t seq, const ScheduledItem &queued) {
+          return seq < queued.seq;
+        });
+    queue.insert(pos, std::move(item));
+  }
+  auto takeFront() -> ScheduledItem {
+    ScheduledItem item = std::move(queue.front());
+    queue.pop_front();
+    work -= item.cost;
+    return item;
+  }
 };
 
 #endif  // SRC_SCHEDULER_TABLEQUEUE_H_
@@ -1,16 +1,20 @@
 #include "TaskQueue.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
-#include <future>
+#include <exception>
+#include <iostream>
 #include <memory>
 #include <mutex>
-#include <stdexcept>
 #include <string>
 #include <utility>
+#include <variant>
 
 #include "../query/Query.h"
 #include "../query/QueryResult.h"
+#include "../utils/FallbackAnalyzer.h"
 #include "DependencyManager.h"
 #include "ScheduledItem.h"
 #include "TableQueue.h"
@@ -19,21 +23,15 @@ void TaskQueue::setReady() {
   readyToFetch_.store(true, std::memory_order_release);
 }
 
-auto TaskQueue::registerTask(ParsedQuery &&parsedQuery)
-    -> std::future<std::unique_ptr<QueryResult>> {
+void TaskQueue::registerTask(ParsedQuery &&parsedQuery) {
   ParsedQuery prQuery = std::move(parsedQuery);
 
-  // Get future from the promise that Runtime created
-  auto fut = prQuery.promise.get_future();
-
   std::scoped_lock const lock(mu);
 
   if (quitFlag) {
-    auto tmpPromise = std::promise<std::unique_ptr<QueryResult>>();
-    auto tmpFut = tmpPromise.get_future();
-    tmpPromise.set_value(std::make_unique<ErrorMsgResult>(
+    prQuery.result->publish(std::make_unique<ErrorMsgResult>(
         "RegisterTask", "system", "quitFlag active: rejecting new task"));
-    return tmpFut;
+    return;
   }
 
   ScheduledItem item;
@@ -42,142 +40,122 @@ auto TaskQueue::registerTask(ParsedQuery &&parsedQuery)
   item.tableId = prQuery.tableName;
   item.type = prQuery.type;
   item.query = std::move(prQuery.query);
-  item.promise = std::move(prQuery.promise);
+  item.result = prQuery.result;
+  item.cost =
+      static_cast<std::uint32_t>(estimateQueryComplexity(*item.query)) + 1;
 
   submitted.fetch_add(1, std::memory_order_relaxed);
 
-  if (item.type == QueryType::Quit || item.type == QueryType::List ||
-      item.type == QueryType::Listen) {
+  if (item.type == QueryType::List) {
+    catalog.expect(item.seq);
+    lists.emplace_back(item.seq, item.result);
+    answerLists();
+    return;
+  }
+
+  if (item.type == QueryType::Quit || item.type == QueryType::Listen) {
     barriers.emplace_back(std::move(item));
-    return fut;
+    return;
   }
 
+  depManager.markScheduled(item, item.type);
+  if (item.type == QueryType::Load || item.type == QueryType::CopyTable) {
+    watchRecreatedTable(item);
+  }
   if (item.type == QueryType::Load) {
-    depManager.markScheduled(item, item.type);
     loadQueue.emplace_back(std::make_unique<ScheduledItem>(std::move(item)));
-    return fut;
-  }
-
-  if (item.type == QueryType::Dump || item.type == QueryType::Drop ||
-      item.type == QueryType::CopyTable) {
-    depManager.markScheduled(item, item.type);
+    return;
   }
 
   auto &tblPtr = tables[item.tableId];
   if (!tblPtr) {
     tblPtr = std::make_unique<TableQueue>();
   }
-  tblPtr->queue.emplace_back(std::move(item));
-  return fut;
+  if (classifyActions(item) == 0 && item.tableId != controlTableId()) {
+    ++tblPtr->tasks;
+    tblPtr->lastTaskSeq = item.seq;
+  }
+  tblPtr->pushBack(std::move(item));
+  // Tasks may arrive while workers are already fetching (pipelined input)
+  if (tblPtr->idle) {
+    tblPtr->idle = false;
+    indexTable(*tblPtr);
+  } else if (GlobalIndex::contains(*tblPtr) &&
+             indices.front()->order() == TableOrder::Backlog &&
+             tblPtr->work >= 2 * tblPtr->indexedWork) {
+    indexTable(*tblPtr);  // the backlog doubled since it was indexed
+  }
 }
 
 void TaskQueue::buildExecutableFromScheduled(ScheduledItem &src,
                                              ExecutableTask &dst) {
+  // Every field is assigned: workers reuse their task slots
   dst.seq = src.seq;
   dst.type = src.type;
   dst.query = std::move(src.query);
-  dst.promise = std::move(src.promise);
-  dst.execOverride = src.droppedFlag ? []() -> std::unique_ptr<QueryResult> {
-    return std::make_unique<NullQueryResult>();
-  }
-  : nullptr;
-  const ActionList actions = classifyActions(src);
-  const std::string capturedTable =
-      src.tableId;  // src.tableId still valid post-move of query & promise
-  const QueryType capturedType = src.type;
-  const std::uint64_t capturedSeq = src.seq;
-  const DependencyPayload capturedDeps = src.depends;
+  dst.result = src.result;
+  TaskCompletion &done = dst.completion;
+  done.owner = this;
+  done.seq = src.seq;
+  done.type = src.type;
+  done.actions = classifyActions(src);
+  done.blocking = false;
   // Find the TableQueue for this task (if it's a table-based query)
-  TableQueue *capturedTableQ = nullptr;
-  if (!capturedTable.empty() && capturedTable != "__control__") {
-    auto tblIt = tables.find(capturedTable);
+  done.tableQ = nullptr;
+  if (!src.tableId.empty() && src.tableId != "__control__") {
+    auto tblIt = tables.find(src.tableId);
     if (tblIt != tables.end()) {
-      capturedTableQ = tblIt->second.get();
+      done.tableQ = tblIt->second.get();
     }
   }
-  // NOLINTNEXTLINE(bugprone-exception-escape)
-  dst.onCompleted = [this, actions, capturedTable, capturedType, capturedSeq,
-                     capturedDeps, capturedTableQ]() noexcept -> void {
-    try {
-      {
-        std::scoped_lock const callbackLock(mu);
-        ScheduledItem meta;  // placeholder
-        meta.tableId = capturedTable;
-        meta.type = capturedType;
-        meta.seq = capturedSeq;
-        meta.depends = capturedDeps;
-        applyActions(actions, meta);
-        // Upsert next task from the same table queue (if any)
-        if (capturedTableQ != nullptr && !capturedTableQ->queue.empty()) {
-          const ScheduledItem &newHead = capturedTableQ->queue.front();
-          globalIndex.upsert(capturedTableQ, newHead.priority,
-                             fetchTick.load(std::memory_order_relaxed),
-                             newHead.seq);
-        }
-      }
-      running.fetch_sub(1, std::memory_order_relaxed);
-      completed.fetch_add(1, std::memory_order_relaxed);
-    } catch (...) {  // NOLINT(bugprone-empty-catch)
-      // Must not throw from noexcept callback
-      // Errors in completion handling are critical but can't propagate
-    }
-  };
+  // src is discarded once fetched
+  done.tableId = std::move(src.tableId);
+  done.depends = std::move(src.depends);
+  done.catalog.reset();
 }
 
 auto TaskQueue::classifyActions(const ScheduledItem &item) -> ActionList {
-  ActionList actions;
+  ActionList actions = 0;
   switch (item.type) {
   case QueryType::Load:
   case QueryType::CopyTable: {
     bool needRegister = true;
     // For COPYTABLE, always need RegisterTable to register the new table
     if (item.type == QueryType::Load) {
-      // For LOAD, check if the table is already registered
+      // For LOAD, check if the table is already registered. LOADs of a
+      // table are ordered by DependencyManager, so it was registered by an
+      // earlier one
       auto tblIt = tables.find(item.tableId);
       if (tblIt != tables.end() && tblIt->second && tblIt->second->registered) {
-        if (tblIt->second->registerSeq > item.seq) {
-          throw std::invalid_argument(
-              "Wrongly execute a later Load " +
-              std::to_string(tblIt->second->registerSeq) +
-              " before an earlier Load " + std::to_string(item.seq));
-        }
         needRegister = false;
       }
     }
     if (needRegister) {
-      actions.push_back(CompletionAction::RegisterTable);
+      addAction(actions, CompletionAction::RegisterTable);
     }
-    actions.push_back(CompletionAction::UpdateDeps);
+    addAction(actions, CompletionAction::UpdateDeps);
     break;
   }
   case QueryType::Dump:
   case QueryType::Drop: {
-    actions.push_back(CompletionAction::UpdateDeps);
+    addAction(actions, CompletionAction::UpdateDeps);
     break;
   }
   default:
-    // All other table queries should also update dependencies
-    if (!item.tableId.empty()) {
-      actions.push_back(CompletionAction::UpdateDeps);
-    }
+    // Only a LOAD or COPYTABLE recreating the table waits for other tasks
+    // on it, see TableQueue::notifyDeps
     break;
   }
   return actions;
 }
 
-void TaskQueue::applyActions(const ActionList &actions,
-                             const ScheduledItem &item) {
-  for (auto act : actions) {
-    switch (act) {
-    case CompletionAction::RegisterTable: {
-      applyRegisterTable(item);
-      break;
-    }
-    case CompletionAction::UpdateDeps: {
-      applyUpdateDeps(item);
-      break;
-    }
-    }
+void TaskQueue::applyActions(ActionList actions, const ScheduledItem &item) {
+  if ((actions & static_cast<ActionList>(CompletionAction::RegisterTable)) !=
+      0) {
+    applyRegisterTable(item);
+  }
+  if ((actions & static_cast<ActionList>(CompletionAction::UpdateDeps)) != 0) {
+    applyUpdateDeps(item);
   }
 }
 
@@ -204,38 +182,48 @@ void TaskQueue::applyRegisterTable(const ScheduledItem &item) {
 
 void TaskQueue::registerTableQueue(std::unique_ptr<TableQueue> &tblPtr,
                                    const ScheduledItem &item) {
+  // The tasks queued on the table before the LOAD or COPYTABLE have all
+  // completed, DependencyManager makes it wait for them
   TableQueue &tbl = *tblPtr;
   if (!tbl.registered) {
     tbl.registered = true;
     tbl.registerSeq = item.seq;
-    if (!tbl.queue.empty()) {
-      for (auto &pending : tbl.queue) {
-        if (pending.seq < item.seq) {
-          pending.droppedFlag =
-              true;  // mark the queries before registered as dropped
-        }
-      }
-      const ScheduledItem &head = tbl.queue.front();
-      globalIndex.upsert(tblPtr.get(), head.priority,
-                         fetchTick.load(std::memory_order_relaxed), head.seq);
-    }
   }
 }
 
-auto TaskQueue::fetchNext(ExecutableTask &out) -> bool {
-  // Don't fetch until all tasks are registered
+auto TaskQueue::fetchNext(ExecutableTask &out, std::size_t worker,
+                          CompletionBatch *done) -> bool {
+  // Don't fetch until setReady()
   if (!readyToFetch_.load(std::memory_order_acquire)) {
     return false;
   }
 
-  std::scoped_lock const lock(mu);
+  const auto lock = lockForWorker();
+  if (done != nullptr) {
+    for (auto &item : *done) {
+      applyCompletion(item);
+    }
+    done->clear();
+  }
+  readyDepth_.store(indexedTables() + loadQueue.size(),
+                    std::memory_order_relaxed);
+
+  // Called by workers, where an escaping exception terminates the process
+  try {
+    return fetchLocked(out, worker);
+  } catch (const std::exception &e) {
+    std::cerr << "lemondb: error: task queue: " << e.what() << '\n';
+  }
+  return false;
+}
 
+auto TaskQueue::fetchLocked(ExecutableTask &out, std::size_t worker) -> bool {
   while (true) {  // Changed from while (!quitFlag) to process all tasks
     std::unique_ptr<ScheduledItem> loadCand = nullptr;
     ScheduledItem *tableCand = nullptr;
     TableQueue *tableCandQ = nullptr;
 
-    getFetched(loadCand, tableCand, tableCandQ);
+    getFetched(worker, loadCand, tableCand, tableCandQ);
 
     // No candidate case
     if (tableCand == nullptr && loadCand == nullptr) {
@@ -251,24 +239,54 @@ auto TaskQueue::fetchNext(ExecutableTask &out) -> bool {
     }
 
     // Materialize and update structures
+    // The candidate not taken goes back where getFetched found it
     if (preferLoad) {
+      if (tableCandQ != nullptr) {
+        indexTable(*tableCandQ);
+      }
       if (judgeLoadDeps(loadCand)) {
         continue;
       }
-      // loadCand is already moved out from loadQueue at line 291
+      // loadCand is already moved out from loadQueue by getFetched
       buildExecutableFromScheduled(*loadCand, out);
+      out.completion.blocking = blocksOthers(out.completion);
       running.fetch_add(1, std::memory_order_relaxed);
       fetchTick.fetch_add(1, std::memory_order_relaxed);
       return true;
     }
+    if (loadCand != nullptr) {
+      loadQueue.emplace_front(std::move(loadCand));
+    }
     if (tableCandQ != nullptr) {
+      // A read that would wait on its table is not taken out either: the
+      // last read to complete would leave the table idle while it waits
+      const auto *tableDeps = std::get_if<TableDeps>(&tableCand->depends);
+      const bool read =
+          fansOut(tableCand->type) &&
+          (tableDeps == nullptr ||
+           tableDeps->tableDependsOn <=
+               depManager.lastCompletedFor(
+                   DependencyManager::DependencyType::Table,
+                   tableCand->tableId));
+      if (tableCandQ->reading > 0 && !read) {
+        continue;  // the last read of the table to complete puts it back
+      }
       if (judgeNormalDeps(tableCand, tableCandQ)) {
         continue;
       }
       buildExecutableFromScheduled(*tableCand, out);
-      tableCandQ->queue.pop_front();
-      // Don't upsert next task here - will be done in onCompleted to prevent
-      // concurrent execution
+      tableCandQ->takeFront();
+      // Don't upsert next task here - will be done on completion to prevent
+      // concurrent execution - unless both are reads that fan out
+      if (read) {
+        ++tableCandQ->reading;
+        tableCandQ->readSeq = std::max(tableCandQ->readSeq, out.seq);
+        if (!tableCandQ->empty() &&
+            fansOut(tableCandQ->queue.front().type)) {
+          indexTable(*tableCandQ);
+        }
+      }
+      out.completion.blocking = blocksOthers(out.completion);
     }
 
     running.fetch_add(1, std::memory_order_relaxed);
@@ -2,20 +2,24 @@
 #define SRC_SCHEDULER_TASKQUEUE_H_
 
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <deque>
-#include <functional>
-#include <future>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
 #include "../query/Query.h"
 #include "../query/QueryPriority.h"
+#include "CatalogLog.h"
 #include "DependencyManager.h"
 #include "GlobalIndex.h"
+#include "ResultSlots.h"
 #include "ScheduledItem.h"
 #include "TableQueue.h"
 
@@ -26,18 +30,50 @@ struct ParsedQuery {
   QueryType type{QueryType::Nop};
   QueryPriority priority{QueryPriority::LOW};
   std::unique_ptr<Query> query;
-  std::promise<std::unique_ptr<QueryResult>> promise;
+  ResultSlot *result = nullptr;  // where the worker leaves the result
 };
 
-// Executable task given to workers
+class TaskQueue;
+
+// What the TaskQueue needs back once a task's result is published
+struct TaskCompletion {
+  // nullptr once applied
+  TaskQueue *owner = nullptr;      // NOLINT
+  // Table to serve next, if any
+  TableQueue *tableQ = nullptr;    // NOLINT
+  std::uint64_t seq = 0;           // NOLINT
+  QueryType type{QueryType::Nop};  // NOLINT
+  // TaskQueue::ActionList
+  std::uint8_t actions = 0;        // NOLINT
+  // Tasks queued or waiting on the table need it; hand it back right away
+  bool blocking = false;           // NOLINT
+  std::string tableId;             // NOLINT
+  DependencyPayload depends;       // NOLINT
+  // Stats of the table the task created, dropped or resized, see CatalogLog
+  std::optional<TableStats> catalog;  // NOLINT
+
+  // Table whose stats `catalog` holds: the new table of COPYTABLE
+  [[nodiscard]] auto catalogTable() const -> const std::string & {
+    const auto *copy = std::get_if<CopyTableDeps>(&depends);
+    return copy != nullptr ? copy->newTable : tableId;
+  }
+};
+
+// Completions a worker has not handed back yet
+using CompletionBatch = std::vector<TaskCompletion>;
+
+// Executable task given to workers. The completion record is carried
+// inline, so that handing a task to a worker does not allocate; workers keep
+// their tasks in reused slots
 struct ExecutableTask {
   std::uint64_t seq = 0;                               // NOLINT
   QueryType type{QueryType::Nop};                      // NOLINT
   std::unique_ptr<Query> query;                        // NOLINT
-  std::promise<std::unique_ptr<QueryResult>> promise;  // NOLINT
-  std::function<std::unique_ptr<QueryResult>()>
-      execOverride;                   // preset function //NOLINT
-  std::function<void()> onCompleted;  // callback closure //NOLINT
+  ResultSlot *result = nullptr;                        // NOLINT
+  TaskCompletion completion;                           // NOLINT
+
+  // Update the TaskQueue once the result is published; no-op when done
+  void complete() noexcept;
 
   ExecutableTask() = default;
   ~ExecutableTask() = default;
@@ -53,22 +89,49 @@ class QueryResult;
 // TaskQueue public interface
 class TaskQueue {
 public:
-  TaskQueue() = default;
+  // With affinityWorkers > 0 every table is assigned to one of that many
+  // workers, which serves it; other workers only take it when idle. With
+  // numaNodes > 1 worker i is on node i % numaNodes: the LOAD of a table
+  // runs on its worker's node and idle workers steal from their own node first.
+  // A table is handed to one task at a time; with fanOutReads consecutive
+  // reads of a table are handed out together instead, so that workers need
+  // no table locks
+  explicit TaskQueue(TableOrder order = TableOrder::Backlog,
+                     std::size_t affinityWorkers = 0,
+                     std::size_t numaNodes = 1, bool fanOutReads = false);
   ~TaskQueue() = default;
   TaskQueue(const TaskQueue &) = delete;
   TaskQueue &operator=(const TaskQueue &) = delete;  // NOLINT
   TaskQueue(TaskQueue &&) noexcept = delete;
   TaskQueue &operator=(TaskQueue &&) noexcept = delete;  // NOLINT
 
-  // Register a task
-  auto registerTask(ParsedQuery &&parsedQuery)
-      -> std::future<std::unique_ptr<QueryResult>>;
+  // Register a task; its result is published to `parsedQuery.result`
+  void registerTask(ParsedQuery &&parsedQuery);
 
-  // Mark that all tasks have been registered, ready to fetch
+  // Mark that fetching may start. Tasks registered afterwards (pipelined
+  // input) are picked up as they arrive, in seq order
   void setReady();
 
-  // Fetch next executable task, Returns false if no task is ready
-  auto fetchNext(ExecutableTask &out) -> bool;  // NOLINT(runtime/references)
+  // Fetch next executable task for `worker`, Returns false if no task is
+  // ready. The completions in `done` are applied first, under the same lock,
+  // and cleared
+  auto fetchNext(ExecutableTask &out,  // NOLINT(runtime/references)
+                 std::size_t worker = 0,
+                 CompletionBatch *done = nullptr) -> bool;
+
+  // Apply a completion, or apply and clear a batch of them
+  void complete(TaskCompletion &done) noexcept;   // NOLINT(runtime/references)
+  void complete(CompletionBatch &done) noexcept;  // NOLINT(runtime/references)
+
+  // Tables and LOADs that were ready when the last fetch started
+  [[nodiscard]] auto readyDepth() const -> std::size_t {
+    return readyDepth_.load(std::memory_order_relaxed);
+  }
+
+  // How often a worker found the queue locked by another thread, ever
+  [[nodiscard]] auto contention() const -> std::uint64_t {
+    return contended_.load(std::memory_order_relaxed);
+  }
 
 private:
   // Data member
@@ -77,13 +140,34 @@ private:
   std::atomic<std::uint64_t> submitted{0};
   std::atomic<std::uint64_t> running{0};
   std::atomic<std::uint64_t> completed{0};
-  std::atomic<bool> readyToFetch_{false};  // Whether all tasks registered
+  std::atomic<bool> readyToFetch_{false};  // Whether fetching may start
+  std::atomic<std::size_t> readyDepth_{0};
+  std::atomic<std::uint64_t> contended_{0};
+
+  // Lock `mu` for a worker, counting the times it has to wait
+  auto lockForWorker() -> std::unique_lock<std::mutex> {
+    std::unique_lock<std::mutex> lock(mu, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      contended_.fetch_add(1, std::memory_order_relaxed);
+      lock.lock();
+    }
+    return lock;
+  }
 
   // Map of tableId -> TableQueue
   std::unordered_map<std::string, std::unique_ptr<TableQueue>> tables;
 
-  // Cross-table selection structure
-  GlobalIndex globalIndex;
+  // Cross-table selection structure; one per worker with affinity
+  std::vector<std::unique_ptr<GlobalIndex>> indices;
+  std::size_t nodeCount = 1;  // NUMA nodes the workers are dealt to
+  bool fanOutReads_ = false;
+
+  // Whether a task of `type` runs alongside the other reads of its table
+  [[nodiscard]] auto fansOut(QueryType type) const -> bool;
+
+  // Whether a task handed out with `done` holds up other tasks, see
+  // TaskCompletion::blocking
+  [[nodiscard]] auto blocksOthers(const TaskCompletion &done) const -> bool;
 
   // loadQueue: FIFO of ready LOAD items
   std::deque<std::unique_ptr<ScheduledItem>> loadQueue;
@@ -92,26 +176,70 @@ private:
   // DM instance for dependency management
   DependencyManager depManager;
 
-  // Barrier structures for QUIT/LIST queries
+  // Barrier structures for QUIT/LISTEN queries
   std::deque<ScheduledItem> barriers;
   std::deque<TableQueue *> waitingTables;  // tables blocked by current barrier
 
   bool quitFlag = false;  // whether QUIT is fetched
 
+  // LISTs are answered from the catalog once every earlier task completed,
+  // without stopping later ones; see CatalogLog
+  CatalogLog catalog;
+  std::deque<std::pair<std::uint64_t, ResultSlot *>> lists;  // seq order
+  // Every seq up to donePrefix has completed; doneWindow[i] tells whether
+  // donePrefix + 1 + i has
+  std::uint64_t donePrefix = 0;
+  std::deque<bool> doneWindow;
+
+  void markDone(std::uint64_t seq);
+  void answerLists();
+
+  // A task held back on a table counts as this much of the table's work
+  static constexpr std::uint64_t kBlockedTaskWeight = 16;
+
+  // Put a table with queued tasks into the GlobalIndex, or refresh its weight
+  void indexTable(TableQueue &tableQ);  // NOLINT(runtime/references)
+
+  // Pick the best table of `worker`, or steal one if it has none
+  auto pickTable(std::size_t worker,
+                 TableQueue *&picked) -> bool;  // NOLINT(runtime/references)
+
+  [[nodiscard]] auto indexedTables() const -> std::size_t;
+
+  // Worker that serves `tableId`, and whether it is on the node of `worker`
+  auto homeWorker(const std::string &tableId) -> std::size_t;
+  auto onHomeNode(std::size_t worker, const std::string &tableId) -> bool;
+
   // Internal helper to materialize ExecutableTask from a ScheduledItem
   void buildExecutableFromScheduled(
       ScheduledItem &src,    // NOLINT(runtime/references)
       ExecutableTask &dst);  // NOLINT(runtime/references)
 
-  // Completion actions
-  enum class CompletionAction : std::uint8_t { RegisterTable, UpdateDeps };
-  using ActionList = std::vector<CompletionAction>;
+  // Completion actions, kept as bits of an ActionList and applied in the
+  // order listed
+  enum class CompletionAction : std::uint8_t {
+    RegisterTable = 1U << 0U,
+    UpdateDeps = 1U << 1U
+  };
+  using ActionList = std::uint8_t;
+
+  static void addAction(ActionList &actions,  // NOLINT(runtime/references)
+                        CompletionAction action) {
+    actions |= static_cast<ActionList>(action);
+  }
 
   auto classifyActions(const ScheduledItem &item) -> ActionList;
-  void applyActions(const ActionList &actions, const ScheduledItem &item);
+  void applyActions(ActionList actions, const ScheduledItem &item);
+
+  // Apply one completion; `mu` has to be held
+  void applyCompletion(
+      TaskCompletion &done) noexcept;  // NOLINT(runtime/references)
 
   void applyRegisterTable(const ScheduledItem &item);
   void applyUpdateDeps(const ScheduledItem &item);
+  // Make the queries on the table a LOAD or COPYTABLE recreates tell
+  // DependencyManager when they complete; see TableQueue::notifyDeps
+  void watchRecreatedTable(const ScheduledItem &item);
 
   void registerTableQueue(
       std::unique_ptr<TableQueue> &tblPtr,  // NOLINT(runtime/references)
@@ -126,7 +254,11 @@ private:
       std::unique_ptr<ScheduledItem> &readyItem);  // NOLINT(runtime/references)
 
   // FetchNext helpers
+  // Fetch with `mu` held; may throw
+  auto fetchLocked(ExecutableTask &out,  // NOLINT(runtime/references)
+                   std::size_t worker) -> bool;
   void getFetched(
+      std::size_t worker,
       std::unique_ptr<ScheduledItem> &loadCand,    // NOLINT(runtime/references)
       ScheduledItem *&tableCand,                   // NOLINT(runtime/references)
       TableQueue *&tableCandQ);                    // NOLINT(runtime/references)
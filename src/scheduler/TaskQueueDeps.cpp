@@ -1,18 +1,118 @@
 //
-// TaskQueue dependency management implementation
+// TaskQueue completion and dependency management implementation
 //
 
 #include "TaskQueue.h"
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
-#include "../db/Database.h"
 #include "../query/Query.h"
+#include "../query/QueryResult.h"
 #include "ScheduledItem.h"
+#include "TableQueue.h"
+
+void ExecutableTask::complete() noexcept {
+  if (completion.owner != nullptr) {
+    completion.owner->complete(completion);
+  }
+}
+
+void TaskQueue::complete(TaskCompletion &done) noexcept {
+  const auto lock = lockForWorker();
+  applyCompletion(done);
+}
+
+void TaskQueue::complete(CompletionBatch &done) noexcept {
+  if (done.empty()) {
+    return;
+  }
+  {
+    const auto lock = lockForWorker();
+    for (auto &item : done) {
+      applyCompletion(item);
+    }
+  }
+  done.clear();
+}
+
+void TaskQueue::applyCompletion(TaskCompletion &done) noexcept {
+  if (done.owner == nullptr) {
+    return;
+  }
+  done.owner = nullptr;
+  try {
+    if (done.catalog) {
+      catalog.record(done.seq, done.type, done.catalogTable(),
+                     *done.catalog);
+    }
+    // Reads that fan out complete in any order, the last of them to
+    // complete stands for all of them
+    const bool fanned = done.tableQ != nullptr && fansOut(done.type);
+    const bool reading = fanned && --done.tableQ->reading > 0;
+    if (done.actions == 0 && done.tableQ != nullptr) {
+      if (done.tableQ->notifyDeps && !reading) {
+        addAction(done.actions, CompletionAction::UpdateDeps);
+      }
+      if (--done.tableQ->tasks == 0) {
+        done.tableQ->notifyDeps = false;
+      }
+    }
+    if (done.actions != 0 && !reading) {
+      ScheduledItem meta;
+      meta.tableId = std::move(done.tableId);
+      meta.type = done.type;
+      meta.seq = fanned ? done.tableQ->readSeq : done.seq;
+      meta.depends = std::move(done.depends);
+      applyActions(done.actions, meta);
+    }
+    // Upsert next task from the same table queue (if any). While other
+    // reads of the table run, a read next is indexed already and a write
+    // waits for the last of them
+    if (done.tableQ != nullptr && !reading && !done.tableQ->queue.empty()) {
+      indexTable(*done.tableQ);
+    } else if (done.tableQ != nullptr && !reading) {
+      done.tableQ->idle = true;
+    }
+  } catch (...) {  // NOLINT(bugprone-empty-catch)
+    // Must not throw from noexcept callback
+    // Errors in completion handling are critical but can't propagate
+  }
+  running.fetch_sub(1, std::memory_order_relaxed);
+  completed.fetch_add(1, std::memory_order_relaxed);
+  markDone(done.seq);
+  answerLists();
+}
+
+void TaskQueue::markDone(std::uint64_t seq) {
+  const auto offset = static_cast<std::size_t>(seq - donePrefix - 1);
+  if (offset >= doneWindow.size()) {
+    doneWindow.resize(offset + 1, false);
+  }
+  doneWindow[offset] = true;
+  while (!doneWindow.empty() && doneWindow.front()) {
+    doneWindow.pop_front();
+    ++donePrefix;
+  }
+}
+
+void TaskQueue::answerLists() {
+  while (!lists.empty() && lists.front().first == donePrefix + 1) {
+    const auto [seq, result] = lists.front();
+    lists.pop_front();
+    result->publishFrom([this, seq = seq]() -> std::unique_ptr<QueryResult> {
+      return std::make_unique<ListingResult>(catalog.list(seq), "LIST");
+    });
+    completed.fetch_add(1, std::memory_order_relaxed);
+    markDone(seq);
+  }
+}
 
 void TaskQueue::applyUpdateDeps(const ScheduledItem &item) {
   std::vector<std::unique_ptr<ScheduledItem>> readyFileItems;
@@ -26,6 +126,29 @@ void TaskQueue::applyUpdateDeps(const ScheduledItem &item) {
   }
 }
 
+void TaskQueue::watchRecreatedTable(const ScheduledItem &item) {
+  const std::string &tableId =
+      item.type == QueryType::CopyTable
+          ? std::get<CopyTableDeps>(item.depends).newTable
+          : item.tableId;
+  auto tblIt = tables.find(tableId);
+  if (tblIt == tables.end() || !tblIt->second) {
+    return;
+  }
+  TableQueue &tbl = *tblIt->second;
+  if (tbl.tasks > 0) {
+    tbl.notifyDeps = true;
+    return;
+  }
+  // Its queries all completed without DependencyManager seeing them
+  std::vector<std::unique_ptr<ScheduledItem>> readyTableItems;
+  depManager.notifyCompleted(DependencyManager::DependencyType::Table,
+                             tableId, tbl.lastTaskSeq, readyTableItems);
+  for (auto &&readyItem : readyTableItems) {
+    updateReadyTables(readyItem);
+  }
+}
+
 void TaskQueue::updateDependencyRecords(
     const ScheduledItem &item,
     std::vector<std::unique_ptr<ScheduledItem>> &readyFileItems,
@@ -35,15 +158,8 @@ void TaskQueue::updateDependencyRecords(
     const auto &loadDeps = std::get<LoadDeps>(item.depends);
     depManager.notifyCompleted(DependencyManager::DependencyType::File,
                                loadDeps.filePath, item.seq, readyFileItems);
-    if (!loadDeps.pendingTable.empty()) {
-      for (const auto &ptableId : loadDeps.pendingTable) {
-        depManager.notifyCompleted(DependencyManager::DependencyType::Table,
-                                   ptableId, item.seq, readyTableItems);
-      }
-    } else {
-      depManager.notifyCompleted(DependencyManager::DependencyType::Table,
-                                 item.tableId, item.seq, readyTableItems);
-    }
+    depManager.notifyCompleted(DependencyManager::DependencyType::Table,
+                               item.tableId, item.seq, readyTableItems);
     break;
   }
   case QueryType::Dump: {
@@ -83,13 +199,9 @@ void TaskQueue::updateDependencyRecords(
 void TaskQueue::updateReadyFiles(std::unique_ptr<ScheduledItem> &readyItem) {
   if (readyItem->type == QueryType::Load) {
     const auto &rlDeps = std::get<LoadDeps>(readyItem->depends);
-    if (!rlDeps.pendingTable.empty()) {
-      auto &database = Database::getInstance();
-      readyItem->tableId = database.getFileTableName(rlDeps.filePath);
-    } else if (rlDeps.tableDependsOn >
-               depManager.lastCompletedFor(
-                   DependencyManager::DependencyType::Table,
-                   readyItem->tableId)) {
+    if (rlDeps.tableDependsOn >
+        depManager.lastCompletedFor(DependencyManager::DependencyType::Table,
+                                    readyItem->tableId)) {
       const auto &readyTableId = readyItem->tableId;
       depManager.addWait(DependencyManager::DependencyType::Table, readyTableId,
                          std::move(readyItem));
@@ -103,11 +215,10 @@ void TaskQueue::updateReadyFiles(std::unique_ptr<ScheduledItem> &readyItem) {
     pendingTablePtr = std::make_unique<TableQueue>();
   }
   auto &pendingTable = *pendingTablePtr;
-  pendingTable.queue.push_front(std::move(*readyItem));
+  pendingTable.putBack(std::move(*readyItem));
+  pendingTable.idle = false;
   readyItem.reset();
-  const auto &head = pendingTable.queue.front();
-  globalIndex.upsert(pendingTablePtr.get(), head.priority,
-                     fetchTick.load(std::memory_order_relaxed), head.seq);
+  indexTable(pendingTable);
 }
 
 void TaskQueue::updateReadyTables(std::unique_ptr<ScheduledItem> &readyItem) {
@@ -139,9 +250,8 @@ void TaskQueue::updateReadyTables(std::unique_ptr<ScheduledItem> &readyItem) {
     pendingTablePtr = std::make_unique<TableQueue>();
   }
   auto &pendingTable = *pendingTablePtr;
-  pendingTable.queue.push_front(std::move(*readyItem));
+  pendingTable.putBack(std::move(*readyItem));
+  pendingTable.idle = false;
   readyItem.reset();
-  const auto &head = pendingTable.queue.front();
-  globalIndex.upsert(pendingTablePtr.get(), head.priority,
-                     fetchTick.load(std::memory_order_relaxed), head.seq);
+  indexTable(pendingTable);
 }
@@ -4,27 +4,141 @@
 
 #include "TaskQueue.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
+#include <variant>
 
 #include "../query/Query.h"
+#include "../query/QueryHelpers.h"
+#include "GlobalIndex.h"
 #include "ScheduledItem.h"
 #include "TableQueue.h"
 
-void TaskQueue::getFetched(std::unique_ptr<ScheduledItem> &loadCand,
-                           ScheduledItem *&tableCand, TableQueue *&tableCandQ) {
-  if (!loadQueue.empty() && !loadBlocked) {
-    if (!barriers.empty() && loadQueue.front()->seq > barriers.front().seq) {
-      loadBlocked = true;
-    } else {
-      loadCand = std::move(loadQueue.front());
-      loadQueue.pop_front();
+namespace {
+// Jump consistent hash (Lamping, Veach): changing the bucket count moves only
+// the keys that have to move
+auto jumpHash(std::uint64_t key, std::size_t buckets) -> std::size_t {
+  constexpr std::uint64_t kMultiplier = 2862933555777941757ULL;
+  constexpr double kScale = static_cast<double>(std::uint64_t{1} << 31U);
+  std::uint64_t bucket = 0;
+  std::uint64_t next = 0;
+  while (next < buckets) {
+    bucket = next;
+    key = (key * kMultiplier) + 1;
+    next = static_cast<std::uint64_t>(
+        static_cast<double>(bucket + 1) *
+        (kScale / static_cast<double>((key >> 33U) + 1)));
+  }
+  return static_cast<std::size_t>(bucket);
+}
+}  // namespace
+
+TaskQueue::TaskQueue(TableOrder order, std::size_t affinityWorkers,
+                     std::size_t numaNodes, bool fanOutReads)
+    : fanOutReads_(fanOutReads) {
+  const std::size_t count = std::max<std::size_t>(affinityWorkers, 1);
+  nodeCount = std::clamp<std::size_t>(numaNodes, 1, count);
+  indices.reserve(count);
+  for (std::size_t index = 0; index < count; ++index) {
+    indices.push_back(std::make_unique<GlobalIndex>(order));
+  }
+}
+
+void TaskQueue::indexTable(TableQueue &tableQ) {
+  if (!GlobalIndex::contains(tableQ)) {
+    tableQ.indexedTick = fetchTick.load(std::memory_order_relaxed);
+  }
+  tableQ.indexedWork = tableQ.work;
+  const ScheduledItem &head = tableQ.queue.front();
+  if (!tableQ.worker) {
+    tableQ.worker = homeWorker(head.tableId);
+  }
+  const std::uint64_t blocked = depManager.waitingOn(
+      DependencyManager::DependencyType::Table, head.tableId);
+  indices[*tableQ.worker]->upsert(&tableQ, head.priority, tableQ.indexedTick,
+                                  head.seq,
+                                  tableQ.work + (blocked * kBlockedTaskWeight));
+}
+
+auto TaskQueue::pickTable(std::size_t worker, TableQueue *&picked) -> bool {
+  GlobalIndex &own = *indices[worker % indices.size()];
+  if (own.pickBest(picked)) {
+    return true;
+  }
+  // Idle: take the best table of the worker with the most waiting tables,
+  // on this NUMA node if any has some. A table from this node stays with
+  // the thief; one from another node goes back home, where its rows are
+  GlobalIndex *victim = nullptr;
+  bool near = false;
+  for (std::size_t other = 0; other < indices.size(); ++other) {
+    const auto &index = indices[other];
+    const bool sameNode = other % nodeCount == worker % nodeCount;
+    if (!index->empty() &&
+        (victim == nullptr || (sameNode && !near) ||
+         (sameNode == near && index->size() > victim->size()))) {
+      victim = index.get();
+      near = sameNode;
     }
   }
+  if (victim == nullptr || !victim->pickBest(picked)) {
+    return false;
+  }
+  if (near) {
+    picked->worker = worker % indices.size();
+  }
+  return true;
+}
+
+auto TaskQueue::homeWorker(const std::string &tableId) -> std::size_t {
+  const auto tblIt = tables.find(tableId);
+  if (tblIt != tables.end() && tblIt->second && tblIt->second->worker) {
+    return *tblIt->second->worker;
+  }
+  return jumpHash(std::hash<std::string>{}(tableId), indices.size());
+}
+
+auto TaskQueue::onHomeNode(std::size_t worker,
+                           const std::string &tableId) -> bool {
+  return nodeCount == 1 ||
+         homeWorker(tableId) % nodeCount == worker % nodeCount;
+}
+
+auto TaskQueue::indexedTables() const -> std::size_t {
+  std::size_t count = 0;
+  for (const auto &index : indices) {
+    count += index->size();
+  }
+  return count;
+}
+
+auto TaskQueue::fansOut(QueryType type) const -> bool {
+  // A DUMP also waits on its file, it stays on its own
+  return fanOutReads_ && getQueryKind(type) == QueryKind::Read &&
+         type != QueryType::Dump;
+}
+
+auto TaskQueue::blocksOthers(const TaskCompletion &done) const -> bool {
+  // The next of a run of reads is handed out without waiting
+  if (done.tableQ != nullptr && !done.tableQ->queue.empty() &&
+      !(fansOut(done.type) && fansOut(done.tableQ->queue.front().type))) {
+    return true;
+  }
+  using Type = DependencyManager::DependencyType;
+  return depManager.waitingOn(Type::Table, done.tableId) > 0 ||
+         depManager.waitingOn(Type::Table, done.catalogTable()) > 0;
+}
+
+void TaskQueue::getFetched(std::size_t worker,
+                           std::unique_ptr<ScheduledItem> &loadCand,
+                           ScheduledItem *&tableCand, TableQueue *&tableCandQ) {
   TableQueue *picked = nullptr;
-  while (globalIndex.pickBest(picked)) {
+  while (pickTable(worker, picked)) {
     if (picked == nullptr || picked->queue.empty()) {
       continue;
     }
@@ -37,6 +151,17 @@ void TaskQueue::getFetched(std::unique_ptr<ScheduledItem> &loadCand,
     tableCandQ = picked;
     break;
   }
+  // A LOAD allocates the table's rows on the node it runs on (first touch),
+  // so other nodes only take it when they have nothing else to do
+  if (!loadQueue.empty() && !loadBlocked) {
+    if (!barriers.empty() && loadQueue.front()->seq > barriers.front().seq) {
+      loadBlocked = true;
+    } else if (tableCand == nullptr ||
+               onHomeNode(worker, loadQueue.front()->tableId)) {
+      loadCand = std::move(loadQueue.front());
+      loadQueue.pop_front();
+    }
+  }
 }
 
 auto TaskQueue::fetchBarrier(ExecutableTask &out) -> bool {
@@ -56,10 +181,7 @@ auto TaskQueue::fetchBarrier(ExecutableTask &out) -> bool {
     fetchTick.fetch_add(1, std::memory_order_relaxed);
     for (auto *blocked : waitingTables) {
       if (blocked != nullptr && !blocked->queue.empty()) {
-        const ScheduledItem &blockedHead = blocked->queue.front();
-        globalIndex.upsert(blocked, blockedHead.priority,
-                           fetchTick.load(std::memory_order_relaxed),
-                           blockedHead.seq);
+        indexTable(*blocked);
       }
     }
     waitingTables.clear();
@@ -100,8 +222,7 @@ auto TaskQueue::judgeNormalDeps(ScheduledItem *&tableCand,
         depManager.lastCompletedFor(DependencyManager::DependencyType::File,
                                     filePath)) {
       auto waitingP =
-          std::make_unique<ScheduledItem>(std::move(tableCandQ->queue.front()));
-      tableCandQ->queue.pop_front();
+          std::make_unique<ScheduledItem>(tableCandQ->takeFront());
       depManager.addWait(DependencyManager::DependencyType::File, filePath,
                          std::move(waitingP));
       return true;
@@ -110,8 +231,7 @@ auto TaskQueue::judgeNormalDeps(ScheduledItem *&tableCand,
         depManager.lastCompletedFor(DependencyManager::DependencyType::Table,
                                     tableId)) {
       auto waitingP =
-          std::make_unique<ScheduledItem>(std::move(tableCandQ->queue.front()));
-      tableCandQ->queue.pop_front();
+          std::make_unique<ScheduledItem>(tableCandQ->takeFront());
       depManager.addWait(DependencyManager::DependencyType::Table, tableId,
                          std::move(waitingP));
       return true;
@@ -124,8 +244,7 @@ auto TaskQueue::judgeNormalDeps(ScheduledItem *&tableCand,
         DependencyManager::DependencyType::Table, tableId);
     if (dropDeps.tableDependsOn > lastCompleted) {
       auto waitingP =
-          std::make_unique<ScheduledItem>(std::move(tableCandQ->queue.front()));
-      tableCandQ->queue.pop_front();
+          std::make_unique<ScheduledItem>(tableCandQ->takeFront());
       depManager.addWait(DependencyManager::DependencyType::Table, tableId,
                          std::move(waitingP));
       return true;
@@ -139,8 +258,7 @@ auto TaskQueue::judgeNormalDeps(ScheduledItem *&tableCand,
         depManager.lastCompletedFor(DependencyManager::DependencyType::Table,
                                     srcTableId)) {
       auto waitingP =
-          std::make_unique<ScheduledItem>(std::move(tableCandQ->queue.front()));
-      tableCandQ->queue.pop_front();
+          std::make_unique<ScheduledItem>(tableCandQ->takeFront());
       depManager.addWait(DependencyManager::DependencyType::Table, srcTableId,
                          std::move(waitingP));
       return true;
@@ -149,12 +267,24 @@ auto TaskQueue::judgeNormalDeps(ScheduledItem *&tableCand,
         depManager.lastCompletedFor(DependencyManager::DependencyType::Table,
                                     newTable)) {
       auto waitingP =
-          std::make_unique<ScheduledItem>(std::move(tableCandQ->queue.front()));
-      tableCandQ->queue.pop_front();
+          std::make_unique<ScheduledItem>(tableCandQ->takeFront());
       depManager.addWait(DependencyManager::DependencyType::Table, newTable,
                          std::move(waitingP));
       return true;
     }
   }
+  if (std::holds_alternative<TableDeps>(tableCand->depends)) {
+    const auto &tableDeps = std::get<TableDeps>(tableCand->depends);
+    const std::string tableId = tableCand->tableId;
+    if (tableDeps.tableDependsOn >
+        depManager.lastCompletedFor(DependencyManager::DependencyType::Table,
+                                    tableId)) {
+      auto waitingP =
+          std::make_unique<ScheduledItem>(tableCandQ->takeFront());
+      depManager.addWait(DependencyManager::DependencyType::Table, tableId,
+                         std::move(waitingP));
+      return true;
+    }
+  }
   return false;
 }
@@ -85,6 +85,41 @@ inline void handle_long_option(size_t *index, std::span<char *> argv,
         warn_invalid_threads(value_req);
       }
     }
+  } else if (name == "io-threads") {
+    const auto value_req = require_value("io-threads");
+    if (!value_req.empty()) {
+      if (auto parsed = parse_int64_sv(value_req)) {
+        out->ioThreads = *parsed;
+      } else {
+        std::cerr << "lemondb: warning: invalid value for --io-threads "
+                  << value_req << '\n';
+      }
+    }
+  } else if (name == "dump-format") {
+    const auto value_req = require_value("dump-format");
+    if (!value_req.empty()) {
+      out->dumpFormat.assign(value_req);
+    }
+  } else if (name == "output-flush") {
+    const auto value_req = require_value("output-flush");
+    if (!value_req.empty()) {
+      out->outputFlush.assign(value_req);
+    }
+  } else if (name == "table-order") {
+    const auto value_req = require_value("table-order");
+    if (!value_req.empty()) {
+      out->tableOrder.assign(value_req);
+    }
+  } else if (name == "async-dump" && !has_value) {
+    out->asyncDump = true;
+  } else if (name == "batch-plan" && !has_value) {
+    out->batchPlan = true;
+  } else if (name == "affinity" && !has_value) {
+    out->affinity = true;
+  } else if (name == "numa" && !has_value) {
+    out->numa = true;
+  } else if (name == "actors" && !has_value) {
+    out->actors = true;
   } else {
     warn_unknown(std::string("--") + std::string(name));
   }
@@ -12,6 +12,15 @@
 struct ParsedArgs {
   std::string listen;
   int64_t threads = 0;
+  int64_t ioThreads = 0;
+  std::string dumpFormat = "auto";
+  std::string outputFlush = "auto";
+  std::string tableOrder = "backlog";
+  bool asyncDump = false;
+  bool batchPlan = false;
+  bool affinity = false;
+  bool numa = false;
+  bool actors = false;
 };
 
 auto parseArgs(std::span<char *> argv, int argc) -> ParsedArgs;
@@ -4,10 +4,12 @@
 
 #include "FallbackAnalyzer.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <filesystem>
 #include <memory>
 #include <string>
-#include <unordered_set>
+#include <system_error>
 #include <vector>
 
 #include "../query/Query.h"
@@ -18,6 +20,17 @@ constexpr size_t kSimpleOpComplexity = 1;
 constexpr size_t kScanOpComplexity = 2;
 constexpr size_t kTableOpComplexity = 5;
 constexpr size_t kFileIOComplexity = 10;
+
+// Rows' worth of work every query costs besides its scan (lookup, result)
+constexpr double kQueryBaseRows = 16;
+// Average size of a table file row, to estimate table sizes from LOAD
+constexpr double kBytesPerRow = 16;
+
+auto estimateFileRows(const std::string &path) -> double {
+  std::error_code error;
+  const auto bytes = std::filesystem::file_size(path, error);
+  return error ? 0 : static_cast<double>(bytes) / kBytesPerRow;
+}
 }  // namespace
 
 // Estimate complexity based on query type
@@ -63,43 +76,100 @@ auto estimateQueryComplexity(const Query &query) -> size_t {
   }
 }
 
-// Analyze workload from query list
-auto analyzeWorkload(const std::vector<Query::Ptr> &queries) -> WorkloadStats {
-  WorkloadStats stats;
-  std::unordered_set<std::string> uniqueTables;
+auto estimateQueryWork(const Query &query, double tableRows) -> double {
+  const auto complexity = static_cast<double>(estimateQueryComplexity(query));
+  if (query.type() == QueryType::Insert) {
+    return complexity * kQueryBaseRows;  // touches one row
+  }
+  return complexity * (kQueryBaseRows + tableRows);
+}
 
-  stats.queryCount = queries.size();
+void WorkloadTracker::add(const Query &query) {
+  ++queryCount_;
+  const QueryType type = query.type();
+  if (type == QueryType::Quit ||
+      (type == QueryType::List && listIsBarrier_)) {
+    ++barrierCount_;
+    return;
+  }
+  const std::string &tableId = query.table();
+  if (tableId.empty()) {
+    return;
+  }
 
-  for (const auto &query : queries) {
-    // Count unique tables
-    const std::string &tableId = query->table();
-    if (!tableId.empty()) {
-      uniqueTables.insert(tableId);
-    }
+  TableLoad &table = tables_[tableId];
+  if (type == QueryType::Load) {
+    table.rows = estimateFileRows(query.filePath());
   }
+  const double work = estimateQueryWork(query, table.rows);
+  table.work += work;
+  work_ += work;
+  busiestTable_ = std::max(busiestTable_, table.work);
 
-  stats.tableCount = uniqueTables.size();
+  switch (type) {
+  case QueryType::Insert:
+    table.rows += 1;
+    break;
+  case QueryType::Drop:
+  case QueryType::Truncate:
+    table.rows = 0;
+    break;
+  case QueryType::CopyTable: {
+    const double rows = table.rows;  // `table` may move on insertion
+    tables_[query.newTable()].rows = rows;
+    break;
+  }
+  default:
+    break;
+  }
+}
 
+auto WorkloadTracker::stats() const -> WorkloadStats {
+  WorkloadStats stats;
+  stats.queryCount = queryCount_;
+  stats.tableCount = tables_.size();
+  stats.barrierCount = barrierCount_;
+  stats.work = work_;
+  stats.busiestTable = busiestTable_;
   return stats;
 }
 
-// Decide whether to fallback to single-threaded mode
-auto shouldFallback([[maybe_unused]] size_t threadCount,
-                    const WorkloadStats &stats,
-                    const FallbackThresholds &thresholds) -> bool {
-  // Fallback if any dimension is below threshold
-  if (stats.queryCount < thresholds.minQueries) {
-    return true;
+// Analyze workload from query list
+auto analyzeWorkload(const std::vector<Query::Ptr> &queries) -> WorkloadStats {
+  WorkloadTracker tracker;
+  for (const auto &query : queries) {
+    tracker.add(*query);
   }
+  return tracker.stats();
+}
 
-  if (stats.tableCount < thresholds.minTables) {
-    return true;
+auto estimateRunNanos(size_t workers, const WorkloadStats &stats,
+                      const CostCalibration &costs) -> double {
+  if (workers <= 1) {
+    return stats.work * costs.rowNanos;
   }
+  const auto count = static_cast<double>(workers);
+  const auto parallel =
+      static_cast<double>(std::min(workers, std::max<size_t>(costs.cores, 1)));
+  // Queries of one table run one at a time
+  const double compute =
+      std::max(stats.work / parallel, stats.busiestTable) * costs.rowNanos;
+  const double handoffs = (static_cast<double>(stats.queryCount) +
+                           (static_cast<double>(stats.barrierCount) * count)) *
+                          costs.handoffNanos;
+  return compute + handoffs + (count * costs.threadNanos);
+}
 
-  // Disabled: Thread count check
-  // if (threadCount < thresholds.minThreads) {
-  //   return true;
-  // }
-
-  return false;
+auto chooseWorkerCount(size_t maxThreads, const WorkloadStats &stats,
+                       const CostCalibration &costs) -> size_t {
+  size_t best = 1;
+  double bestNanos = estimateRunNanos(1, stats, costs);
+  for (size_t workers = 2; workers <= maxThreads; ++workers) {
+    const double nanos = estimateRunNanos(workers, stats, costs);
+    if (nanos < bestNanos) {
+      best = workers;
+      bestNanos = nanos;
+    }
+  }
+  return best;
 }
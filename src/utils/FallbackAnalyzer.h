@@ -1,5 +1,12 @@
 //
-// Fallback Analyzer - Decides whether to fallback to single-threaded mode
+// Fallback Analyzer - Decides how many workers a workload is worth
+// The decision compares estimated run times: single-threaded, the workload
+// costs its work; with k workers the work is split k ways, but no faster than
+// the busiest table (its queries run one at a time) or the available cores
+// allow, plus the cost of handing every query to a worker, of draining all
+// workers at every barrier and of starting the workers. Work is counted in
+// rows touched, costs in nanoseconds as measured by calibrateCosts on the
+// running machine.
 //
 
 #ifndef SRC_UTILS_FALLBACKANALYZER_H_
@@ -7,35 +14,79 @@
 
 #include <cstddef>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "../query/Query.h"
 
-// Thresholds for fallback decision
-struct FallbackThresholds {
-  static constexpr size_t kDefaultMinQueries = 1000;
+// Measured costs of this machine
+struct CostCalibration {
+  static constexpr double kDefaultRowNanos = 2.0;
+  static constexpr double kDefaultHandoffNanos = 2000.0;
+  static constexpr double kDefaultThreadNanos = 50000.0;
 
-  size_t minQueries =
-      kDefaultMinQueries;  // Minimum query count for multi-threading
-  size_t minTables = 3;    // Minimum table count for multi-threading
-  // size_t minThreads = 4;  // Disabled: Minimum thread count for
-  // multi-threading
+  double rowNanos = kDefaultRowNanos;  // evaluating a condition on one row
+  // Handing one task to another thread and its result back
+  double handoffNanos = kDefaultHandoffNanos;
+  double threadNanos = kDefaultThreadNanos;  // starting and joining a thread
+  size_t cores = 1;  // hardware threads, more workers only add overhead
 };
 
+// Run short micro-benchmarks (about a millisecond) to measure the costs
+auto calibrateCosts() -> CostCalibration;
+
 // Workload statistics
 struct WorkloadStats {
   size_t queryCount = 0;
   size_t tableCount = 0;
+  size_t barrierCount = 0;  // QUIT (and LIST in a batch plan) drain workers
+  double work = 0;          // estimated rows touched by all queries
+  double busiestTable = 0;  // estimated rows touched on the busiest table
+};
+
+// Workload statistics collected one query at a time, so that the decision
+// can be taken on a prefix of the input (every statistic only grows)
+class WorkloadTracker {
+public:
+  // The task queue answers LIST without draining the workers; a batch plan
+  // still runs it as a barrier
+  explicit WorkloadTracker(bool listIsBarrier = false)
+      : listIsBarrier_(listIsBarrier) {}
+
+  void add(const Query &query);
+  [[nodiscard]] auto stats() const -> WorkloadStats;
+
+private:
+  struct TableLoad {
+    double rows = 0;  // estimated size: LOADed file, then INSERTs
+    double work = 0;
+  };
+
+  bool listIsBarrier_;
+  size_t queryCount_ = 0;
+  size_t barrierCount_ = 0;
+  double work_ = 0;
+  double busiestTable_ = 0;
+  std::unordered_map<std::string, TableLoad> tables_;
 };
 
 // Estimate complexity of a single query
 auto estimateQueryComplexity(const Query &query) -> size_t;
 
+// Estimate the rows a query touches on a table of `tableRows` rows
+auto estimateQueryWork(const Query &query, double tableRows) -> double;
+
 // Analyze workload from query list
 auto analyzeWorkload(const std::vector<Query::Ptr> &queries) -> WorkloadStats;
 
-// Decide whether to fallback to single-threaded mode
-auto shouldFallback(size_t threadCount, const WorkloadStats &stats,
-                    const FallbackThresholds &thresholds) -> bool;
+// Estimated wall time of the workload on `workers` workers
+auto estimateRunNanos(size_t workers, const WorkloadStats &stats,
+                      const CostCalibration &costs) -> double;
+
+// Worker count, at most `maxThreads`, expected to finish the workload first;
+// 1 means falling back to single-threaded mode
+auto chooseWorkerCount(size_t maxThreads, const WorkloadStats &stats,
+                       const CostCalibration &costs) -> size_t;
 
 #endif  // SRC_UTILS_FALLBACKANALYZER_H_
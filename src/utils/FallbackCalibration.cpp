@@ -0,0 +1,123 @@
+//
+// Fallback Analyzer calibration micro-benchmarks
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "../db/Table.h"
+#include "FallbackAnalyzer.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kCalibrationRows = 4096;
+constexpr std::size_t kCalibrationFields = 4;
+constexpr std::uint32_t kHandoffRounds = 64;
+// Measurements below clock resolution are not trusted
+constexpr double kMinNanos = 0.1;
+
+auto nanosSince(Clock::time_point start) -> double {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+      .count();
+}
+
+// A WHERE condition, evaluated the way ComplexQuery::evalCondition does
+struct Condition {
+  std::string field;
+  Table::FieldIndex fieldId;
+  std::function<bool(const Table::ValueType &, const Table::ValueType &)>
+      comp;
+  Table::ValueType value;
+};
+
+// Cost of evaluating a condition on one row of a real table
+auto measureRowNanos() -> double {
+  const std::vector<std::string> fields{"a", "b", "c", "d"};
+  Table table("__calibration__", fields);
+  table.reserve(kCalibrationRows);
+  for (std::size_t row = 0; row < kCalibrationRows; ++row) {
+    const auto value = static_cast<Table::ValueType>(row);
+    table.insertByIndex("k" + std::to_string(row),
+                        std::vector<Table::ValueType>(kCalibrationFields,
+                                                      value));
+  }
+
+  const std::vector<Condition> conditions{
+      {"a", 0, std::greater<>(), static_cast<Table::ValueType>(
+                                     kCalibrationRows / 2)}};
+  const auto start = Clock::now();
+  std::int64_t sum = 0;
+  for (auto &&obj : table) {
+    bool match = true;
+    for (const auto &cond : conditions) {
+      if (cond.field != "KEY") {
+        match = match && cond.comp(obj[cond.fieldId], cond.value);
+      }
+    }
+    if (match) {
+      sum += obj[1];
+    }
+  }
+  const double nanos = nanosSince(start);
+  // Keep the scan from being optimized away
+  volatile std::int64_t sink = sum;  // NOLINT
+  static_cast<void>(sink);
+  return nanos / static_cast<double>(kCalibrationRows);
+}
+
+// Wait until `turn` reaches `expected`
+void waitFor(const std::atomic<std::uint32_t> &turn, std::uint32_t expected) {
+  std::uint32_t seen = turn.load(std::memory_order_acquire);
+  while (seen != expected) {
+    turn.wait(seen, std::memory_order_acquire);
+    seen = turn.load(std::memory_order_acquire);
+  }
+}
+
+void pass(std::atomic<std::uint32_t> &turn,  // NOLINT(runtime/references)
+          std::uint32_t value) {
+  turn.store(value, std::memory_order_release);
+  turn.notify_one();
+}
+}  // namespace
+
+auto calibrateCosts() -> CostCalibration {
+  CostCalibration costs;
+  costs.cores = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  costs.rowNanos = std::max(measureRowNanos(), kMinNanos);
+
+  // Play ping-pong with one thread: the first round includes starting it
+  std::atomic<std::uint32_t> turn{0};
+  auto start = Clock::now();
+  std::thread peer([&turn]() {
+    for (std::uint32_t round = 0; round <= kHandoffRounds; ++round) {
+      waitFor(turn, (2 * round) + 1);
+      pass(turn, (2 * round) + 2);
+    }
+  });
+  pass(turn, 1);
+  waitFor(turn, 2);
+  double threadNanos = nanosSince(start);
+
+  start = Clock::now();
+  for (std::uint32_t round = 1; round <= kHandoffRounds; ++round) {
+    pass(turn, (2 * round) + 1);
+    waitFor(turn, (2 * round) + 2);
+  }
+  costs.handoffNanos = std::max(
+      nanosSince(start) / static_cast<double>(kHandoffRounds), kMinNanos);
+
+  start = Clock::now();
+  peer.join();
+  threadNanos += nanosSince(start);
+  costs.threadNanos = std::max(threadNanos, kMinNanos);
+  return costs;
+}
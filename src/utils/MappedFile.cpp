@@ -0,0 +1,85 @@
+//
+// MappedFile implementation
+//
+
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : addr_(std::exchange(other.addr_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      fallback_(std::move(other.fallback_)),
+      opened_(std::exchange(other.opened_, false)) {}
+
+auto MappedFile::operator=(MappedFile &&other) noexcept -> MappedFile & {
+  if (this != &other) {
+    close();
+    addr_ = std::exchange(other.addr_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    fallback_ = std::move(other.fallback_);
+    opened_ = std::exchange(other.opened_, false);
+  }
+  return *this;
+}
+
+auto MappedFile::open(const std::string &path) -> bool {
+  close();
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    const auto length = static_cast<std::size_t>(info.st_size);
+    void *addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    // MAP_FAILED casts -1 to a pointer
+    if (addr != MAP_FAILED) {  // NOLINT
+      ::madvise(addr, length, MADV_SEQUENTIAL);
+      addr_ = addr;
+      size_ = length;
+      opened_ = true;
+      ::close(fd);
+      return true;
+    }
+  }
+  // Not mappable: read everything into the owned buffer
+  constexpr std::size_t readChunk = 1U << 16U;
+  std::array<char, readChunk> chunk{};
+  while (true) {
+    const ssize_t got = ::read(fd, chunk.data(), chunk.size());
+    if (got < 0) {
+      ::close(fd);
+      fallback_.clear();
+      return false;
+    }
+    if (got == 0) {
+      break;
+    }
+    fallback_.append(chunk.data(), static_cast<std::size_t>(got));
+  }
+  ::close(fd);
+  opened_ = true;
+  return true;
+}
+
+void MappedFile::close() {
+  if (addr_ != nullptr) {
+    ::munmap(addr_, size_);
+    addr_ = nullptr;
+    size_ = 0;
+  }
+  fallback_.clear();
+  opened_ = false;
+}
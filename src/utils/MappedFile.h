@@ -0,0 +1,47 @@
+//
+// MappedFile - read-only memory mapping of a whole file
+// Falls back to reading the file into an owned buffer when it cannot be
+// mapped (pipes, special files, ...), so callers always get a contiguous view.
+//
+
+#ifndef SRC_UTILS_MAPPEDFILE_H_
+#define SRC_UTILS_MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  auto operator=(const MappedFile &) -> MappedFile & = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  auto operator=(MappedFile &&other) noexcept -> MappedFile &;
+
+  // Map the file, returns false if it cannot be opened
+  auto open(const std::string &path) -> bool;
+
+  void close();
+
+  [[nodiscard]] auto isOpen() const -> bool { return opened_; }
+
+  [[nodiscard]] auto view() const -> std::string_view {
+    if (addr_ != nullptr) {
+      return {static_cast<const char *>(addr_), size_};
+    }
+    return fallback_;
+  }
+
+  [[nodiscard]] auto size() const -> std::size_t { return view().size(); }
+
+private:
+  void *addr_{nullptr};
+  std::size_t size_{0};
+  std::string fallback_;  // used when mmap is not possible
+  bool opened_{false};
+};
+
+#endif  // SRC_UTILS_MAPPEDFILE_H_
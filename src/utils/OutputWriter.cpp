@@ -0,0 +1,166 @@
+//
+// OutputWriter implementation
+//
+
+#include "OutputWriter.h"
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <ios>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace {
+auto sameDestination(int lhs, int rhs) -> bool {
+  struct stat lhsStat {};
+  struct stat rhsStat {};
+  if (fstat(lhs, &lhsStat) != 0 || fstat(rhs, &rhsStat) != 0) {
+    return false;
+  }
+  return lhsStat.st_dev == rhsStat.st_dev && lhsStat.st_ino == rhsStat.st_ino;
+}
+
+// Write every byte of `iov`, retrying partial writes. Output that cannot be
+// written (closed pipe, full disk) is dropped like std::cout would.
+void writeAll(int fd, std::vector<iovec> &iov) {
+  std::size_t first = 0;
+  while (first < iov.size()) {
+    const auto count = static_cast<int>(
+        std::min<std::size_t>(iov.size() - first, IOV_MAX));
+    const ssize_t written = writev(fd, &iov[first], count);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    auto left = static_cast<std::size_t>(written);
+    while (first < iov.size() && left >= iov[first].iov_len) {
+      left -= iov[first].iov_len;
+      ++first;
+    }
+    if (left > 0) {
+      iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + left;
+      iov[first].iov_len -= left;
+    }
+  }
+}
+}  // namespace
+
+auto OutputWriter::Channel::xsputn(const char *str, std::streamsize count)
+    -> std::streamsize {
+  writer_.append(fd_, {str, static_cast<std::size_t>(count)});
+  return count;
+}
+
+auto OutputWriter::Channel::overflow(int_type chr) -> int_type {
+  if (!traits_type::eq_int_type(chr, traits_type::eof())) {
+    const char character = traits_type::to_char_type(chr);
+    writer_.append(fd_, {&character, 1});
+  }
+  return traits_type::not_eof(chr);
+}
+
+OutputWriter::OutputWriter()
+    : outBuf_(*this, STDOUT_FILENO), errBuf_(*this, STDERR_FILENO),
+      out_(&outBuf_), err_(&errBuf_),
+      shared_(sameDestination(STDOUT_FILENO, STDERR_FILENO)) {}
+
+OutputWriter::~OutputWriter() { flush(); }
+
+auto OutputWriter::getInstance() -> OutputWriter & {
+  static OutputWriter instance;
+  return instance;
+}
+
+auto OutputWriter::parsePolicy(std::string_view value)
+    -> std::optional<FlushPolicy> {
+  if (value == "auto") {
+    return FlushPolicy::Auto;
+  }
+  if (value == "query") {
+    return FlushPolicy::Query;
+  }
+  if (value == "idle") {
+    return FlushPolicy::Idle;
+  }
+  if (value == "full") {
+    return FlushPolicy::Full;
+  }
+  return std::nullopt;
+}
+
+void OutputWriter::setPolicy(FlushPolicy policy) {
+  if (policy == FlushPolicy::Auto) {
+    policy = isatty(STDOUT_FILENO) != 0 ? FlushPolicy::Query
+                                        : FlushPolicy::Idle;
+  }
+  policy_ = policy;
+}
+
+void OutputWriter::append(int fd, std::string_view text) {
+  if (used_ == 0 || blocks_[used_ - 1].fd != fd ||
+      blocks_[used_ - 1].text.size() + text.size() > blockSize) {
+    if (used_ == blocks_.size()) {
+      blocks_.emplace_back();
+    }
+    blocks_[used_].fd = fd;
+    ++used_;
+  }
+  blocks_[used_ - 1].text.append(text);
+  bytes_ += text.size();
+}
+
+void OutputWriter::endOfResult() {
+  if (policy_ == FlushPolicy::Query || bytes_ >= capacity ||
+      used_ >= maxBlocks) {
+    flush();
+  }
+}
+
+void OutputWriter::idle() {
+  if (policy_ != FlushPolicy::Full) {
+    flush();
+  }
+}
+
+void OutputWriter::flush() {
+  if (shared_) {
+    // Runs of blocks alternate between the streams, write them in order
+    std::size_t first = 0;
+    while (first < used_) {
+      std::size_t last = first + 1;
+      while (last < used_ && blocks_[last].fd == blocks_[first].fd) {
+        ++last;
+      }
+      writeBlocks(blocks_[first].fd, first, last);
+      first = last;
+    }
+  } else {
+    writeBlocks(STDOUT_FILENO, 0, used_);
+    writeBlocks(STDERR_FILENO, 0, used_);
+  }
+  for (std::size_t index = 0; index < used_; ++index) {
+    blocks_[index].text.clear();
+  }
+  used_ = 0;
+  bytes_ = 0;
+}
+
+void OutputWriter::writeBlocks(int fd, std::size_t first, std::size_t last) {
+  std::vector<iovec> iov;
+  for (std::size_t index = first; index < last; ++index) {
+    Block &block = blocks_[index];
+    if (block.fd == fd && !block.text.empty()) {
+      iov.push_back({block.text.data(), block.text.size()});
+    }
+  }
+  writeAll(fd, iov);
+}
@@ -0,0 +1,100 @@
+//
+// OutputWriter - buffered stdout/stderr for query results
+// Result text is gathered in blocks and handed to the kernel with one writev
+// per stream and flush. When stdout and stderr reach the same file, pipe or
+// terminal, blocks keep the order in which both streams were written; else
+// each stream is written on its own. Only one thread may write at a time.
+//
+
+#ifndef SRC_UTILS_OUTPUTWRITER_H_
+#define SRC_UTILS_OUTPUTWRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// When buffered results are written out
+enum class FlushPolicy : std::uint8_t {
+  Auto,   // Query on a terminal, Idle otherwise
+  Query,  // after every result
+  Idle,   // when the buffer is full or the output waits for a result
+  Full,   // only when the buffer is full, and at exit
+};
+
+class OutputWriter {
+public:
+  static constexpr std::size_t capacity = std::size_t{1} << 20U;
+  static constexpr std::size_t blockSize = std::size_t{1} << 16U;
+  static constexpr std::size_t maxBlocks = 256;
+
+  static auto getInstance() -> OutputWriter &;
+
+  static auto parsePolicy(std::string_view value)
+      -> std::optional<FlushPolicy>;
+
+  OutputWriter(const OutputWriter &) = delete;
+  auto operator=(const OutputWriter &) -> OutputWriter & = delete;
+  OutputWriter(OutputWriter &&) = delete;
+  auto operator=(OutputWriter &&) -> OutputWriter & = delete;
+
+  // Buffered text is written before the process exits
+  ~OutputWriter();
+
+  void setPolicy(FlushPolicy policy);
+
+  auto out() -> std::ostream & { return out_; }
+  auto err() -> std::ostream & { return err_; }
+
+  // One query result has been written completely
+  void endOfResult();
+
+  // The output is about to wait for a result that is not complete yet
+  void idle();
+
+  void flush();
+
+private:
+  OutputWriter();
+
+  class Channel : public std::streambuf {
+  public:
+    Channel(OutputWriter &writer, int fd) : writer_(writer), fd_(fd) {}
+
+  protected:
+    auto xsputn(const char *str, std::streamsize count)
+        -> std::streamsize override;
+    auto overflow(int_type chr) -> int_type override;
+
+  private:
+    OutputWriter &writer_;
+    int fd_;
+  };
+
+  struct Block {
+    int fd{-1};
+    std::string text;
+  };
+
+  void append(int fd, std::string_view text);
+
+  // writev every block of `fd` in [first, last)
+  void writeBlocks(int fd, std::size_t first, std::size_t last);
+
+  Channel outBuf_;
+  Channel errBuf_;
+  std::ostream out_;
+  std::ostream err_;
+  std::vector<Block> blocks_;  // blocks past `used_` are kept for reuse
+  std::size_t used_{0};
+  std::size_t bytes_{0};
+  bool shared_;  // both streams reach the same file, keep their order
+  FlushPolicy policy_{FlushPolicy::Idle};
+};
+
+#endif  // SRC_UTILS_OUTPUTWRITER_H_
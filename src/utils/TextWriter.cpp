@@ -0,0 +1,24 @@
+//
+// TextWriter implementation
+//
+
+#include "TextWriter.h"
+
+#include <cstddef>
+#include <ios>
+#include <ostream>
+
+TextWriter::TextWriter(std::ostream &os, std::size_t capacity)
+    : os_(os), capacity_(capacity) {
+  // Leave room for the item that crosses the flush threshold
+  buffer_.reserve(capacity_ + capacity_ / 4);
+}
+
+TextWriter::~TextWriter() { flush(); }
+
+void TextWriter::flush() {
+  if (!buffer_.empty()) {
+    os_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+  }
+}
@@ -0,0 +1,105 @@
+//
+// TextWriter - buffered text serializer for table output
+// Integers are formatted with std::to_chars and columns are padded by hand,
+// matching what std::setw produces for right-aligned output.
+//
+
+#ifndef SRC_UTILS_TEXTWRITER_H_
+#define SRC_UTILS_TEXTWRITER_H_
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+template <typename Int>
+using IntDigits = std::array<char, std::numeric_limits<Int>::digits10 + 3>;
+
+template <typename Int>
+auto formatInt(IntDigits<Int> &digits, Int value) -> std::string_view {
+  char *first = digits.data();
+  auto res = std::to_chars(
+      first, std::next(first, static_cast<std::ptrdiff_t>(digits.size())),
+      value);
+  return {first, static_cast<std::size_t>(res.ptr - first)};
+}
+
+// Append the decimal form of an integer
+template <typename Int> void appendInt(std::string &out, Int value) {
+  IntDigits<Int> digits{};
+  out.append(formatInt(digits, value));
+}
+
+// Append text right-aligned in a column, like `os << std::setw(width)`
+inline void appendRight(std::string &out, std::string_view text,
+                        std::size_t width) {
+  if (text.size() < width) {
+    out.append(width - text.size(), ' ');
+  }
+  out.append(text);
+}
+
+template <typename Int>
+void appendRightInt(std::string &out, Int value, std::size_t width) {
+  IntDigits<Int> digits{};
+  appendRight(out, formatInt(digits, value), width);
+}
+
+class TextWriter {
+public:
+  static constexpr std::size_t defaultCapacity = 1U << 18U;
+
+  explicit TextWriter(std::ostream &os,
+                      std::size_t capacity = defaultCapacity);
+  ~TextWriter();
+
+  TextWriter(const TextWriter &) = delete;
+  auto operator=(const TextWriter &) -> TextWriter & = delete;
+  TextWriter(TextWriter &&) = delete;
+  auto operator=(TextWriter &&) -> TextWriter & = delete;
+
+  void put(std::string_view text) {
+    buffer_.append(text);
+    maybeFlush();
+  }
+
+  void put(char chr) {
+    buffer_.push_back(chr);
+    maybeFlush();
+  }
+
+  template <typename Int> void putInt(Int value) {
+    appendInt(buffer_, value);
+    maybeFlush();
+  }
+
+  void putRight(std::string_view text, std::size_t width) {
+    appendRight(buffer_, text, width);
+    maybeFlush();
+  }
+
+  template <typename Int> void putRightInt(Int value, std::size_t width) {
+    appendRightInt(buffer_, value, width);
+    maybeFlush();
+  }
+
+  // Hand the buffered text to the stream
+  void flush();
+
+private:
+  void maybeFlush() {
+    if (buffer_.size() >= capacity_) {
+      flush();
+    }
+  }
+
+  std::ostream &os_;
+  std::string buffer_;
+  std::size_t capacity_;
+};
+
+#endif  // SRC_UTILS_TEXTWRITER_H_
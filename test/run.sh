@@ -109,6 +109,7 @@ case "${BASH_REMATCH[1]}" in
   11|many_read_dup) run_test many_read_dup || exit 1 ;;
   12|many_read_update) run_test many_read_update || exit 1 ;;
   13|many_insert_delete) run_test many_insert_delete || exit 1 ;;
+  14|reload_writes) run_test reload_writes || exit 1 ;;
   *) exit 0 ;;
 esac
 check_result "ALL" 0